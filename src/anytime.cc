@@ -0,0 +1,46 @@
+#include "anytime.hpp"
+#include "rounding.hpp"
+
+string get_stage_name(Anytime_Stage stage) {
+  switch(stage) {
+    case Anytime_Stage::tower: return "tower";
+    case Anytime_Stage::compacted: return "compacted";
+    default: return "greedy";
+  }
+}
+
+Anytime_Result schedule_jobs_within(Machines m, const Job_List& jobs, chrono::microseconds budget, const Backend_Thresholds& thresholds) {
+  auto start = chrono::steady_clock::now();
+  auto elapsed = [&]() { return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count(); };
+
+  Anytime_Result result = with_tower_schedule(select_backend(jobs, m, thresholds), m, jobs.size(), [&](auto& tower_schedule) {
+    typedef typename decay_t<decltype(tower_schedule)>::Schedule Schedule;
+
+    Job_List sorted_jobs = jobs;
+    sort_jobs_decreasingly_by_required_machines(sorted_jobs);
+    Schedule greedy(m, jobs.size());
+    greedy.list_schedule(sorted_jobs);
+    Anytime_Result best = {greedy.placed_jobs, greedy.get_makespan(), Anytime_Stage::greedy, 0.0, 0.0};
+    double greedy_time = elapsed();
+
+    if(elapsed() + ANYTIME_TOWER_TIME_FACTOR * greedy_time <= budget.count()) {
+      tower_schedule.schedule_jobs(jobs);
+      if(tower_schedule.sigma.get_makespan() < best.makespan)
+        best = {tower_schedule.sigma.placed_jobs, tower_schedule.sigma.get_makespan(), Anytime_Stage::tower, 0.0, 0.0};
+    }
+
+    // no job starts later after the compaction, so the makespan can not grow
+    if(elapsed() + ANYTIME_COMPACTION_TIME_FACTOR * greedy_time <= budget.count()) {
+      Schedule compacted(m, jobs.size());
+      compacted.placed_jobs = best.placed_jobs;
+      if(compacted.compact() < best.makespan)
+        best = {compacted.placed_jobs, compacted.get_makespan(), Anytime_Stage::compacted, 0.0, 0.0};
+    }
+    return best;
+  });
+
+  double lower_bound = get_makespan_lower_bound(jobs, m);
+  result.ratio = lower_bound == 0 ? 1.0 : result.makespan / lower_bound;
+  result.elapsed_ms = elapsed() / 1000;
+  return result;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "types.hpp"
+#include "gap_backend.hpp"
+
+#include <chrono>
+
+// the stage which produced the schedule of schedule_jobs_within
+enum class Anytime_Stage {
+  greedy,     // list schedule of the jobs sorted decreasingly by required machines
+  tower,      // tower schedule
+  compacted   // the best schedule compacted by backfilling (see compact_jobs)
+};
+
+string get_stage_name(Anytime_Stage stage);
+
+struct Anytime_Result {
+  Job_List placed_jobs;
+  Time makespan;
+  Anytime_Stage stage;
+  // makespan / max(area/m, p_max)
+  double ratio;
+  double elapsed_ms;
+};
+
+// the tower schedule takes about this many times as long as the greedy schedule
+// (measured on random instances with m=100000 and 10^3 to 10^5 jobs: 2 to 2.5)
+const double ANYTIME_TOWER_TIME_FACTOR = 3.0;
+// same for the compaction of the best schedule (measured: 1.6 to 1.9)
+const double ANYTIME_COMPACTION_TIME_FACTOR = 2.0;
+
+// the greedy schedule is always computed, the later stages only run if their time (predicted from the
+// time of the greedy schedule) fits into what is left of budget, the shortest schedule is returned
+// a stage can not be interrupted, so the budget is only exceeded by a misprediction
+Anytime_Result schedule_jobs_within(Machines m, const Job_List& jobs, chrono::microseconds budget, const Backend_Thresholds& thresholds = DEFAULT_BACKEND_THRESHOLDS);
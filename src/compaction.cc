@@ -0,0 +1,174 @@
+#include "compaction.hpp"
+
+#include <random>
+
+// available machines as changes at their times (the change at time 0 is the number of machines)
+class Profile_Treap {
+public:
+  Profile_Treap() : root(NONE), gen(42) {}
+
+  void add(Time time, long long change) {
+    auto [lower, rest] = split(root, time);
+    auto [node, upper] = split(rest, time+1);
+    if(node == NONE) {
+      nodes.push_back(Node{time, change, static_cast<uint32_t>(gen()), NONE, NONE, 0, 0, 0});
+      node = static_cast<int>(nodes.size()-1);
+    }
+    else
+      nodes[node].change += change;
+    update(node);
+    root = merge(merge(lower, node), upper);
+  }
+
+  // available machines at time
+  long long get_available_machines(Time time) const {
+    long long available_machines = 0;
+    int node = root;
+    while(node != NONE) {
+      if(nodes[node].time <= time) {
+        available_machines += sum(nodes[node].left) + nodes[node].change;
+        node = nodes[node].right;
+      }
+      else
+        node = nodes[node].left;
+    }
+    return available_machines;
+  }
+
+  // first change after time where at least (at_least=true) or fewer than (at_least=false) required machines are available
+  optional<Time> find_next_change(Time time, long long required_machines, bool at_least) const {
+    return find_after(root, time, 0, required_machines, at_least);
+  }
+
+private:
+  static constexpr int NONE = -1;
+
+  // the prefix sums are the available machines from the first time of the subtree on
+  struct Node {
+    Time time;
+    long long change;
+    uint32_t priority;
+    int left, right;
+    long long sum, min_prefix, max_prefix;
+  };
+
+  vector<Node> nodes;
+  int root;
+  mt19937 gen;
+
+  long long sum(int node) const {
+    return node == NONE ? 0 : nodes[node].sum;
+  }
+
+  void update(int node) {
+    Node& n = nodes[node];
+    long long left_sum = sum(n.left);
+    long long with_node = left_sum + n.change;
+    n.sum = with_node + sum(n.right);
+    n.min_prefix = n.max_prefix = with_node;
+    if(n.left != NONE) {
+      n.min_prefix = min(n.min_prefix, nodes[n.left].min_prefix);
+      n.max_prefix = max(n.max_prefix, nodes[n.left].max_prefix);
+    }
+    if(n.right != NONE) {
+      n.min_prefix = min(n.min_prefix, with_node + nodes[n.right].min_prefix);
+      n.max_prefix = max(n.max_prefix, with_node + nodes[n.right].max_prefix);
+    }
+  }
+
+  // times below time and the others
+  pair<int, int> split(int node, Time time) {
+    if(node == NONE)
+      return {NONE, NONE};
+    if(nodes[node].time < time) {
+      auto [lower, upper] = split(nodes[node].right, time);
+      nodes[node].right = lower;
+      update(node);
+      return {node, upper};
+    }
+    auto [lower, upper] = split(nodes[node].left, time);
+    nodes[node].left = upper;
+    update(node);
+    return {lower, node};
+  }
+
+  int merge(int lower, int upper) {
+    if(lower == NONE)
+      return upper;
+    if(upper == NONE)
+      return lower;
+    if(nodes[lower].priority > nodes[upper].priority) {
+      nodes[lower].right = merge(nodes[lower].right, upper);
+      update(lower);
+      return lower;
+    }
+    nodes[upper].left = merge(lower, nodes[upper].left);
+    update(upper);
+    return upper;
+  }
+
+  bool may_contain(int node, long long before, long long required_machines, bool at_least) const {
+    return node != NONE && (at_least ? before + nodes[node].max_prefix >= required_machines
+                                     : before + nodes[node].min_prefix < required_machines);
+  }
+
+  // before is the sum of the changes in front of the subtree
+  optional<Time> find_after(int node, Time time, long long before, long long required_machines, bool at_least) const {
+    if(node == NONE)
+      return nullopt;
+    const Node& n = nodes[node];
+    if(n.time <= time)
+      return find_after(n.right, time, before + sum(n.left) + n.change, required_machines, at_least);
+
+    // all times of the right subtree are after time
+    if(optional<Time> found = find_after(n.left, time, before, required_machines, at_least))
+      return found;
+    long long available_machines = before + sum(n.left) + n.change;
+    if(at_least ? available_machines >= required_machines : available_machines < required_machines)
+      return n.time;
+    return find_first(n.right, available_machines, required_machines, at_least);
+  }
+
+  optional<Time> find_first(int node, long long before, long long required_machines, bool at_least) const {
+    while(may_contain(node, before, required_machines, at_least)) {
+      const Node& n = nodes[node];
+      if(may_contain(n.left, before, required_machines, at_least)) {
+        node = n.left;
+        continue;
+      }
+      before += sum(n.left) + n.change;
+      if(at_least ? before >= required_machines : before < required_machines)
+        return n.time;
+      node = n.right;
+    }
+    return nullopt;
+  }
+};
+
+// the old starting time is free for the job: the jobs taken before it started at or before it and only moved down,
+// so they end at or before their old completion times
+Job_List compact_jobs(Job_List placed_jobs, Machines m) {
+  sort_jobs_increasingly_by_starting_time(placed_jobs);
+
+  Profile_Treap profile;
+  profile.add(0, m);
+  for(Job& job : placed_jobs) {
+    long long required_machines = job.required_machines;
+    Time time = 0;
+    while(true) {
+      if(profile.get_available_machines(time) < required_machines)
+        time = profile.find_next_change(time, required_machines, /*at_least=*/true).value();
+      optional<Time> too_few_machines = profile.find_next_change(time, required_machines, /*at_least=*/false);
+      if(!too_few_machines.has_value() || too_few_machines.value() >= time + job.processing_time)
+        break;
+      time = too_few_machines.value();
+    }
+
+    job.starting_time = time;
+    profile.add(job.starting_time.value(), -required_machines);
+    profile.add(job.starting_time.value() + job.processing_time, required_machines);
+  }
+
+  sort_jobs_increasingly_by_starting_time(placed_jobs);
+  return placed_jobs;
+}
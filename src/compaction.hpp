@@ -0,0 +1,10 @@
+#pragma once
+
+#include "types.hpp"
+
+// backfilling: the jobs are taken in the order of their starting times and each one is moved down
+// to the earliest time where enough machines are available during its whole processing time
+// (among the jobs taken before it), a job never starts later than before
+// the profile is a treap of changes with the smallest and largest prefix sums per subtree,
+// so the next time with enough (or too few) machines is found in O(log n) and a job costs O(log n) per hole it skips
+Job_List compact_jobs(Job_List placed_jobs, Machines m);
@@ -0,0 +1,299 @@
+#include "dense_gap_manager.hpp"
+
+Dense_Gap_Manager::Dense_Gap_Manager(Machines m, Time time_horizon)
+    : m(m), makespan(0), available_machines_after_end(m)
+  {
+    grow_to(time_horizon);
+    reset_structure();
+  }
+
+void Dense_Gap_Manager::reset_structure() {
+  current_time = 0;
+  available_machines_in_gap = get_available_machines(0);
+}
+
+void Dense_Gap_Manager::set_structure_to_top() {
+  current_time = makespan;
+  available_machines_in_gap = m;
+}
+
+void Dense_Gap_Manager::place_job_at(Job job, Time time) {
+  Time end_time = checked_add(time, job.processing_time);
+  add_additional_machines_in(time, end_time, -static_cast<Machine_Change>(job.required_machines));
+
+  if(time <= current_time && current_time < end_time)
+    available_machines_in_gap -= job.required_machines;
+
+  if(makespan < end_time)
+    makespan = end_time;
+}
+
+void Dense_Gap_Manager::add_additional_machines_at(Time time, Machine_Change additional_machines) {
+  add_additional_machines_in(time, INVALID_TIME, static_cast<Machine_Change>(additional_machines));
+
+  if(current_time >= time)
+    available_machines_in_gap += additional_machines;
+}
+
+void Dense_Gap_Manager::place_jobs(const Job_List& jobs) {
+  for(const Job& job : jobs)
+    place_job_at(job, job.starting_time.value());
+}
+
+// the changes are turned into one range update per distinct time
+void Dense_Gap_Manager::add_additional_machines(vector<Gap> changes) {
+  auto by_time = [](const Gap& g1, const Gap& g2) { return g1.time < g2.time; };
+  if(!is_sorted(changes.begin(), changes.end(), by_time))
+    sort(changes.begin(), changes.end(), by_time);
+
+  Machine_Change additional_machines = 0;
+  size_t i = 0;
+  while(i < changes.size()) {
+    Time time = changes[i].time;
+    for(; i < changes.size() && changes[i].time == time; i++) {
+      additional_machines += changes[i].additional_machines;
+      if(current_time >= time)
+        available_machines_in_gap += changes[i].additional_machines;
+    }
+
+    Time next_time = i < changes.size() ? changes[i].time : INVALID_TIME;
+    add_additional_machines_in(time, next_time, additional_machines);
+  }
+}
+
+void Dense_Gap_Manager::remove_jobs(const Job_List& jobs) {
+  if(jobs.empty())
+    return;
+
+  for(const Job& job : jobs) {
+    Time time = job.starting_time.value();
+    Time end_time = checked_add(time, job.processing_time);
+    add_additional_machines_in(time, end_time, static_cast<Machine_Change>(job.required_machines));
+
+    if(time <= current_time && current_time < end_time)
+      available_machines_in_gap += job.required_machines;
+  }
+
+  update_makespan_after_removal();
+}
+
+void Dense_Gap_Manager::remove_job_at(Job job, Time time) {
+  Time end_time = checked_add(time, job.processing_time);
+  add_additional_machines_in(time, end_time, static_cast<Machine_Change>(job.required_machines));
+
+  if(time <= current_time && current_time < end_time)
+    available_machines_in_gap += job.required_machines;
+
+  update_makespan_after_removal();
+}
+
+Time Dense_Gap_Manager::update_earliest_time_to_place(Job job) {
+  Gap_Cursor cursor = {current_time, available_machines_in_gap};
+  find_earliest_time_to_place(job, cursor);
+  current_time = cursor.time;
+  available_machines_in_gap = cursor.available_machines;
+  return current_time;
+}
+
+Gap_Cursor Dense_Gap_Manager::get_start_cursor() const {
+  return Gap_Cursor{0, static_cast<Machines>(get_available_machines(0))};
+}
+
+// skips all blocks whose maximum is too small
+Time Dense_Gap_Manager::find_earliest_time_to_place(Job job, Gap_Cursor& cursor) const {
+  // the cursor keeps negative available machines with the width of the machines
+  if(fits(static_cast<Machine_Change>(cursor.available_machines), job.required_machines))
+    return cursor.time;
+
+  size_t size = available_machines.size();
+
+  size_t time = cursor.time;
+  bool found = false;
+  if(time < size) {
+    size_t block = time / BLOCK_SIZE;
+    if(block_may_fit(block, job.required_machines))
+      for(; time < (block+1)*BLOCK_SIZE; time++)
+        if(fits(available_machines[time], job.required_machines)) {
+          found = true;
+          break;
+        }
+
+    for(block++; !found && block < block_maximum.size(); block++) {
+      if(!block_may_fit(block, job.required_machines))
+        continue;
+      for(time = block*BLOCK_SIZE; time < (block+1)*BLOCK_SIZE; time++)
+        if(fits(available_machines[time], job.required_machines)) {
+          found = true;
+          break;
+        }
+    }
+  }
+
+  if(!found) {
+    if(!fits(available_machines_after_end, job.required_machines))
+      throw std::runtime_error("should never happen");
+    time = max(static_cast<size_t>(cursor.time), size);
+  }
+
+  cursor.time = time;
+  cursor.available_machines = get_available_machines(cursor.time);
+  return cursor.time;
+}
+
+Gap_Cursor Dense_Gap_Manager::get_cursor_at(Time time) const {
+  return Gap_Cursor{time, static_cast<Machines>(get_available_machines(time))};
+}
+
+// the time units of the processing time are checked, the search goes on from the first one which is too small
+Time Dense_Gap_Manager::find_earliest_time_to_fit(Job job, Gap_Cursor& cursor) const {
+  while(true) {
+    find_earliest_time_to_place(job, cursor);
+
+    Time end_time = min<size_t>(static_cast<size_t>(cursor.time) + job.processing_time, available_machines.size());
+    Time time = cursor.time+1;
+    while(time < end_time && fits(available_machines[time], job.required_machines))
+      time++;
+
+    if(time >= end_time)
+      return cursor.time;
+    cursor = get_cursor_at(time);
+  }
+}
+
+// all time units after the end of the array have the same available machines
+Machines Dense_Gap_Manager::get_minimum_available_machines(Gap_Cursor cursor, Time end_time) const {
+  Machine_Change minimum = static_cast<Machine_Change>(cursor.available_machines);
+  Time end = min<size_t>(end_time, available_machines.size());
+  for(Time time = cursor.time+1; time < end; time++)
+    minimum = min(minimum, available_machines[time]);
+  if(available_machines.size() < end_time)
+    minimum = min(minimum, available_machines_after_end);
+  return static_cast<Machines>(minimum);
+}
+
+Absolute_Gap_List Dense_Gap_Manager::build_inverse_absolute_gaps() {
+  reset_structure();
+  return get_inverse_absolute_gaps();
+}
+
+// the same list as for the tree: {0, m} and then for every change at time t below the makespan
+// (from top to bottom) the available machines directly above t
+Absolute_Gap_List Dense_Gap_Manager::get_inverse_absolute_gaps() const {
+  Absolute_Gap_List inverse_absolute_gaps = {Absolute_Gap{0, m}};
+  for(Time time = makespan; time-- > 0;) {
+    Machine_Change available = get_available_machines(time);
+    if(time == 0 || get_available_machines(time-1) != available)
+      inverse_absolute_gaps.push_back(Absolute_Gap{static_cast<Time>(makespan - time), static_cast<Machines>(available)});
+  }
+  return inverse_absolute_gaps;
+}
+
+Time Dense_Gap_Manager::get_makespan() const {
+  return makespan;
+}
+
+// other is left without jobs
+void Dense_Gap_Manager::stack_on_top(Dense_Gap_Manager& other) {
+  stack_gaps_on_top(other.get_gaps(), other.makespan);
+  other = Dense_Gap_Manager(other.m);
+}
+
+void Dense_Gap_Manager::stack_gaps_on_top(const vector<Gap>& stacked_gaps, Time height) {
+  if(height == 0)
+    return;
+
+  Time offset = makespan;
+
+  Machine_Change available_machines_at_offset = 0;
+  if(!stacked_gaps.empty() && stacked_gaps[0].time == 0)
+    available_machines_at_offset = stacked_gaps[0].additional_machines;
+
+  vector<Gap> shifted_gaps = {Gap{offset, static_cast<Machine_Change>(available_machines_at_offset - static_cast<Machine_Change>(m))}};
+  shifted_gaps.reserve(stacked_gaps.size()+1);
+  for(const Gap& gap : stacked_gaps)
+    if(gap.time != 0 && gap.additional_machines != 0)
+      shifted_gaps.push_back(Gap{checked_add(gap.time, offset), gap.additional_machines});
+  add_additional_machines(shifted_gaps);
+
+  // the structure below the offset is unchanged
+  if(current_time >= offset) {
+    current_time = offset;
+    available_machines_in_gap = available_machines_at_offset;
+  }
+
+  makespan = checked_add(offset, height);
+}
+
+size_t Dense_Gap_Manager::get_number_of_gaps() const {
+  size_t number_of_gaps = 1;
+  for(Time time = 1; time <= available_machines.size(); time++)
+    if(get_available_machines(time) != get_available_machines(time-1))
+      number_of_gaps++;
+  return number_of_gaps;
+}
+
+vector<Gap> Dense_Gap_Manager::get_gaps() const {
+  vector<Gap> gap_list = {Gap{0, get_available_machines(0)}};
+  for(Time time = 1; time <= available_machines.size(); time++) {
+    Machine_Change additional_machines = get_available_machines(time) - get_available_machines(time-1);
+    if(additional_machines != 0)
+      gap_list.push_back(Gap{time, additional_machines});
+  }
+  return gap_list;
+}
+
+vector<Gap> Dense_Gap_Manager::get_rotated_gaps() const {
+  return rotate_gaps(get_gaps(), makespan, m);
+}
+
+Machine_Change Dense_Gap_Manager::get_available_machines(Time time) const {
+  return time < available_machines.size() ? available_machines[time] : available_machines_after_end;
+}
+
+// adds additional_machines to all time units in [begin, end) (end=INVALID_TIME for all times after begin)
+void Dense_Gap_Manager::add_additional_machines_in(Time begin, Time end, Machine_Change additional_machines) {
+  if(additional_machines == 0 || begin >= end)
+    return;
+
+  if(end == INVALID_TIME) {
+    grow_to(begin);
+    available_machines_after_end += additional_machines;
+    end = available_machines.size();
+  }
+  else
+    grow_to(end);
+
+  for(Time time = begin; time < end; time++)
+    available_machines[time] += additional_machines;
+
+  // blocks which are covered completely are shifted, the others are scanned again
+  for(size_t block = begin / BLOCK_SIZE; block * BLOCK_SIZE < end; block++) {
+    size_t block_begin = block * BLOCK_SIZE;
+    if(begin <= block_begin && block_begin + BLOCK_SIZE <= end)
+      block_maximum[block] += additional_machines;
+    else
+      block_maximum[block] = *max_element(available_machines.begin() + block_begin,
+                                          available_machines.begin() + block_begin + BLOCK_SIZE);
+  }
+}
+
+void Dense_Gap_Manager::grow_to(Time end) {
+  size_t size = available_machines.size();
+  if(end <= size)
+    return;
+
+  size_t new_size = max((static_cast<size_t>(end) + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE, 2*size);
+  available_machines.resize(new_size, available_machines_after_end);
+  block_maximum.resize(new_size / BLOCK_SIZE, available_machines_after_end);
+}
+
+// the same rule as for the tree, where the makespan is the last change if its entry vanished
+void Dense_Gap_Manager::update_makespan_after_removal() {
+  if(makespan != 0 && get_available_machines(makespan-1) != get_available_machines(makespan))
+    return;
+
+  Time time = available_machines.size();
+  while(time > 0 && available_machines[time-1] == available_machines_after_end)
+    time--;
+  makespan = time;
+}
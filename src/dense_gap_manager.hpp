@@ -0,0 +1,98 @@
+#pragma once
+#include "types.hpp"
+#include "gap_manager.hpp"
+
+
+// gap structure which stores the available machines for every time unit
+// (instead of the changes of available machines at some times)
+// meant for schedules with a small makespan, where the array is cheaper than the tree
+// the maximum of every block of time units is kept to skip full blocks when searching
+class Dense_Gap_Manager {
+public:
+  static const uint BLOCK_SIZE = 64;
+
+  Machines m;
+
+  // time_horizon is only a hint, the structure grows if jobs end later
+  Dense_Gap_Manager(Machines m, Time time_horizon = 0);
+
+  void reset_structure();
+
+  void set_structure_to_top();
+
+  void place_job_at(Job job, Time time);
+
+  void add_additional_machines_at(Time time, Machine_Change additional_machines);
+
+  void place_jobs(const Job_List& jobs);
+
+  void add_additional_machines(vector<Gap> changes);
+
+  void remove_jobs(const Job_List& jobs);
+
+  void remove_job_at(Job job, Time time);
+
+  Time update_earliest_time_to_place(Job job);
+
+  Gap_Cursor get_start_cursor() const;
+
+  Time find_earliest_time_to_place(Job job, Gap_Cursor& cursor) const;
+
+  Gap_Cursor get_cursor_at(Time time) const;
+
+  Time find_earliest_time_to_fit(Job job, Gap_Cursor& cursor) const;
+
+  Machines get_minimum_available_machines(Gap_Cursor cursor, Time end_time) const;
+
+  Absolute_Gap_List build_inverse_absolute_gaps();
+
+  Absolute_Gap_List get_inverse_absolute_gaps() const;
+
+  Time get_makespan() const;
+
+  // other is left without jobs
+  void stack_on_top(Dense_Gap_Manager& other);
+
+  void stack_gaps_on_top(const vector<Gap>& stacked_gaps, Time height);
+
+  // number of times at which the available machines change
+  size_t get_number_of_gaps() const;
+
+  vector<Gap> get_gaps() const;
+
+  vector<Gap> get_rotated_gaps() const;
+
+  // available machines in [time, time+1)
+  Machine_Change get_available_machines(Time time) const;
+
+  // the cursor as in the tree
+  Time current_time;
+  Machines available_machines_in_gap;
+
+  Time makespan;
+
+/* private: */
+  // available machines per time unit (size is a multiple of BLOCK_SIZE)
+  vector<Machine_Change> available_machines;
+  // maximum of available_machines in each block
+  vector<Machine_Change> block_maximum;
+  // available machines after the end of available_machines
+  Machine_Change available_machines_after_end;
+
+  // adds additional_machines to all time units in [begin, end) (end=INVALID_TIME for all times after begin)
+  void add_additional_machines_in(Time begin, Time end, Machine_Change additional_machines);
+
+  void grow_to(Time end);
+
+  // compared signed, an overfull time (negative available machines) does not fit any job
+  bool fits(Machine_Change available, Machines required_machines) const {
+    return static_cast<long long>(available) >= static_cast<long long>(required_machines);
+  }
+
+  bool block_may_fit(size_t block, Machines required_machines) const {
+    return fits(block_maximum[block], required_machines);
+  }
+
+  // the same rule as for the tree, where the makespan is the last change if its entry vanished
+  void update_makespan_after_removal();
+};
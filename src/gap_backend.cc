@@ -0,0 +1,113 @@
+#include "gap_backend.hpp"
+
+#include <chrono>
+#include <random>
+#include <limits>
+
+string get_backend_name(Gap_Backend backend) {
+  switch(backend) {
+    case Gap_Backend::map: return "map";
+    case Gap_Backend::flat: return "flat";
+    case Gap_Backend::dense: return "dense";
+    default: return "tree";
+  }
+}
+
+// the projected makespan is the area bound plus one processing time (an upper bound for the dense array)
+Gap_Backend select_backend(const Job_List& jobs, Machines m, const Backend_Thresholds& thresholds) {
+  if(jobs.size() <= thresholds.flat_max_jobs)
+    return Gap_Backend::flat;
+
+  try {
+    unsigned long long area = 0;
+    Time p_max = 0;
+    for(const Job& job : jobs) {
+      area = checked_add(area, checked_multiply<unsigned long long>(job.processing_time, job.required_machines));
+      p_max = max(p_max, job.processing_time);
+    }
+
+    if(area / m + p_max <= thresholds.dense_max_makespan)
+      return Gap_Backend::dense;
+  }
+  catch(const overflow_error&) {
+    // far too large for the dense structure
+  }
+
+  return thresholds.tree_backend;
+}
+
+Tower_Result schedule_with_backend(Gap_Backend backend, Machines m, const Job_List& jobs) {
+  return with_tower_schedule(backend, m, jobs.size(), [&](auto& tower_schedule) {
+    tower_schedule.schedule_jobs(jobs);
+    return Tower_Result{tower_schedule.sigma.placed_jobs, tower_schedule.sigma.get_makespan(), backend};
+  });
+}
+
+Tower_Result schedule_with_selected_backend(Machines m, const Job_List& jobs, const Backend_Thresholds& thresholds) {
+  return schedule_with_backend(select_backend(jobs, m, thresholds), m, jobs);
+}
+
+// small instances are repeated to get measurable times, the minimum of the runs is taken
+// the flat list is not measured anymore once it lost (it is quadratic in the number of gaps)
+// the backends have to give the same schedule, otherwise their times are not comparable (throws logic_error)
+Backend_Thresholds calibrate_backend_thresholds(Machines m, Time p_max, const vector<uint>& numbers_of_jobs) {
+  Backend_Thresholds thresholds = {0, 0, Gap_Backend::tree};
+
+  mt19937 gen(42);
+  uniform_int_distribution<Time> dist_time(1, p_max);
+  uniform_int_distribution<Machines> dist_machines(1, m);
+
+  bool flat_lost = false;
+  double tree_time = 0, map_time = 0;
+  for(uint n : numbers_of_jobs) {
+    Job_List jobs;
+    jobs.reserve(n);
+    unsigned long long area = 0;
+    for(uint i = 0; i < n; i++) {
+      jobs.emplace_back(dist_time(gen), dist_machines(gen));
+      area += static_cast<unsigned long long>(jobs.back().processing_time) * jobs.back().required_machines;
+    }
+
+    uint repetitions = clamp(10000 / max(n, 1u), 1u, 10u);
+    optional<Tower_Result> tree_result;
+    auto measure = [&](Gap_Backend backend) {
+      double best = numeric_limits<double>::infinity();
+      for(uint r = 0; r < repetitions; r++) {
+        auto start = chrono::steady_clock::now();
+        Tower_Result result = schedule_with_backend(backend, m, jobs);
+        chrono::duration<double> duration = chrono::steady_clock::now() - start;
+        best = min(best, duration.count());
+
+        if(!tree_result.has_value())
+          tree_result = result;
+        else if(!equal(result.placed_jobs.begin(), result.placed_jobs.end(),
+                       tree_result->placed_jobs.begin(), tree_result->placed_jobs.end(),
+                       [](const Job& j1, const Job& j2) { return j1.starting_time == j2.starting_time; }))
+          throw logic_error("the " + get_backend_name(backend) + " backend gives another schedule than the tree");
+      }
+      return best;
+    };
+
+    double times[4];
+    for(Gap_Backend backend : {Gap_Backend::tree, Gap_Backend::map, Gap_Backend::dense})
+      times[static_cast<int>(backend)] = measure(backend);
+    times[static_cast<int>(Gap_Backend::flat)] = flat_lost ? numeric_limits<double>::infinity()
+                                                           : measure(Gap_Backend::flat);
+
+    double fastest = *min_element(times, times+4);
+    if(!flat_lost && times[static_cast<int>(Gap_Backend::flat)] == fastest)
+      thresholds.flat_max_jobs = n;
+    else
+      flat_lost = true;
+
+    if(times[static_cast<int>(Gap_Backend::dense)] <= min(times[static_cast<int>(Gap_Backend::tree)],
+                                                          times[static_cast<int>(Gap_Backend::map)]))
+      thresholds.dense_max_makespan = max(thresholds.dense_max_makespan, area / m + p_max);
+
+    tree_time += times[static_cast<int>(Gap_Backend::tree)];
+    map_time += times[static_cast<int>(Gap_Backend::map)];
+  }
+
+  thresholds.tree_backend = map_time < tree_time ? Gap_Backend::map : Gap_Backend::tree;
+  return thresholds;
+}
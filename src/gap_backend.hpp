@@ -0,0 +1,78 @@
+#pragma once
+
+#include "types.hpp"
+#include "gap_manager.hpp"
+#include "dense_gap_manager.hpp"
+#include "tower_schedule.hpp"
+
+// the gap structures the tower schedule is instantiated with
+enum class Gap_Backend {
+  tree,   // pb_ds tree of changes (Gap_Manager)
+  map,    // std::map of changes (Map_Gap_Manager)
+  flat,   // sorted vector of changes (Flat_Gap_Manager)
+  dense   // available machines per time unit (Dense_Gap_Manager)
+};
+
+string get_backend_name(Gap_Backend backend);
+
+// thresholds of select_backend (measured with calibrate_backend_thresholds)
+struct Backend_Thresholds {
+  // the flat list is used up to this number of jobs
+  uint flat_max_jobs;
+  // otherwise the dense structure is used up to this projected makespan (area/m + p_max)
+  unsigned long long dense_max_makespan;
+  // otherwise this tree (tree or map) is used
+  Gap_Backend tree_backend;
+};
+
+// measured on random instances with m=100000 and p_max=100: the flat list wins up to a few thousand jobs,
+// dense and map are about equal for makespans in the millions (the dense array is capped to 16 MB)
+const Backend_Thresholds DEFAULT_BACKEND_THRESHOLDS = {
+  /*flat_max_jobs=*/3000,
+  /*dense_max_makespan=*/1ull << 22,
+  /*tree_backend=*/Gap_Backend::map
+};
+
+// every backend gives the same schedule, only the time differs
+Gap_Backend select_backend(const Job_List& jobs, Machines m, const Backend_Thresholds& thresholds = DEFAULT_BACKEND_THRESHOLDS);
+
+// calls function with an empty Basic_Tower_Schedule of the gap structure of backend
+// (the dispatch happens once, everything inside function is instantiated for the structure)
+template<typename Function>
+decltype(auto) with_tower_schedule(Gap_Backend backend, Machines m, uint n, Function&& function) {
+  switch(backend) {
+    case Gap_Backend::map: {
+      Basic_Tower_Schedule<Map_Gap_Manager> tower_schedule(m, n);
+      return function(tower_schedule);
+    }
+    case Gap_Backend::flat: {
+      Basic_Tower_Schedule<Flat_Gap_Manager> tower_schedule(m, n);
+      return function(tower_schedule);
+    }
+    case Gap_Backend::dense: {
+      Basic_Tower_Schedule<Dense_Gap_Manager> tower_schedule(m, n);
+      return function(tower_schedule);
+    }
+    default: {
+      Basic_Tower_Schedule<Gap_Manager> tower_schedule(m, n);
+      return function(tower_schedule);
+    }
+  }
+}
+
+// the resulting schedule of a tower schedule (independent of the gap structure)
+struct Tower_Result {
+  Job_List placed_jobs;
+  Time makespan;
+  Gap_Backend backend;
+};
+
+Tower_Result schedule_with_backend(Gap_Backend backend, Machines m, const Job_List& jobs);
+
+Tower_Result schedule_with_selected_backend(Machines m, const Job_List& jobs, const Backend_Thresholds& thresholds = DEFAULT_BACKEND_THRESHOLDS);
+
+// micro-benchmark which runs the tower schedule with every backend on random instances
+// (m machines, processing times up to p_max) with the given numbers of jobs
+// the thresholds are derived from the fastest backend for each instance
+// (all backends give the same schedule, so the choice only changes the speed, throws logic_error otherwise)
+Backend_Thresholds calibrate_backend_thresholds(Machines m, Time p_max, const vector<uint>& numbers_of_jobs = {100, 1000, 10000, 100000});
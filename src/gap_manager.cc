@@ -1,90 +1,406 @@
 #include "gap_manager.hpp"
 
-Gap_Manager::Gap_Manager(uint m) 
+// gaps of a profile (ascending in time, starting at time 0) ending at makespan rotated by 180 degrees
+// (the available machines at time t are the available machines of the original profile before makespan-t)
+vector<Gap> rotate_gaps(const vector<Gap>& gaps, Time makespan, Machines m) {
+  // available machines in [time, next time) for all times up to the makespan
+  vector<Gap> absolute_gaps = {Gap{0, 0}};
+  absolute_gaps.reserve(gaps.size());
+  Machine_Change available_machines = 0;
+  for(auto [time, additional_machines] : gaps) {
+    if(time >= makespan)
+      break;
+    available_machines += additional_machines;
+    if(absolute_gaps.back().time == time)
+      absolute_gaps.back().additional_machines = available_machines;
+    else
+      absolute_gaps.push_back(Gap{time, available_machines});
+  }
+
+  // [t_i, t_i+1) with a_i becomes [makespan-t_i+1, makespan-t_i) with a_i 
+  vector<Gap> rotated_gaps;
+  rotated_gaps.reserve(absolute_gaps.size()+1);
+  Machine_Change previous_available_machines = 0;
+  Time next_time = makespan;
+  for(const Gap& gap : absolute_gaps | views::reverse) {
+    rotated_gaps.push_back(Gap{static_cast<Time>(makespan - next_time),
+                               static_cast<Machine_Change>(gap.additional_machines - previous_available_machines)});
+    previous_available_machines = gap.additional_machines;
+    next_time = gap.time;
+  }
+  rotated_gaps.push_back(Gap{static_cast<Time>(makespan - next_time),
+                             static_cast<Machine_Change>(static_cast<Machine_Change>(m) - previous_available_machines)});
+
+  return rotated_gaps;
+}
+
+template<typename Gaps>
+Basic_Gap_Manager<Gaps>::Basic_Gap_Manager(Machines m) 
     : m(m) 
   {
     // at time 0 there are m available machines in an empty schedule
     gaps[0] = m;
+    changed_in_place(0);
     reset_structure();
     makespan = 0;
   }
 
-void Gap_Manager::reset_structure() {
+template<typename Gaps>
+void Basic_Gap_Manager<Gaps>::reset_structure() {
   current_time = 0;
   available_machines_in_gap = gaps[0];
 }
 
-void Gap_Manager::set_structure_to_top() {
+template<typename Gaps>
+void Basic_Gap_Manager<Gaps>::set_structure_to_top() {
   current_time = makespan;
   available_machines_in_gap = m;
 }
 
-void Gap_Manager::place_job_at(Job job, uint time) {
+template<typename Gaps>
+void Basic_Gap_Manager<Gaps>::place_job_at(Job job, Time time) {
+  Time end_time = checked_add(time, job.processing_time);
   // available machines at starttime reduced
-  add_additional_machines_at(time,                    -job.required_machines); 
+  add_additional_machines_at(time,     -job.required_machines); 
   // available machines at endtime increased
-  add_additional_machines_at(time+job.processing_time, job.required_machines);
+  add_additional_machines_at(end_time, job.required_machines);
 
-  if(makespan < time+job.processing_time)
-    makespan = time+job.processing_time;
+  if(makespan < end_time)
+    makespan = end_time;
 }
 
-void Gap_Manager::add_additional_machines_at(uint time, uint additional_machines) { 
-  if (gaps.key_exists(time))
-    gaps[time] += additional_machines;
-  else 
-    gaps[time] = additional_machines;
+// an entry whose change becomes zero is erased (except the one at time 0)
+template<typename Gaps>
+void Basic_Gap_Manager<Gaps>::add_additional_machines_at(Time time, Machine_Change additional_machines) { 
+  auto it = gaps.find(time);
+  if (it == gaps.end()) {
+    if (additional_machines != 0)
+      gaps.insert({time, static_cast<Machine_Change>(additional_machines)});
+  }
+  else if (static_cast<Machine_Change>(it->second + additional_machines) != 0 || time == 0) {
+    it->second += additional_machines;
+    changed_in_place(time);
+  }
+  else
+    gaps.erase(it);
 
   if(current_time >= time)
     available_machines_in_gap += additional_machines;
 }
 
-uint Gap_Manager::update_earliest_time_to_place(Job job) {
-  while(available_machines_in_gap < job.required_machines) {
-    optional<Gap> opt_gap = gaps.get_next_gap(current_time+1);
+// places all jobs at their starting times with one update per distinct time
+template<typename Gaps>
+void Basic_Gap_Manager<Gaps>::place_jobs(const Job_List& jobs) {
+  vector<Gap> changes;
+  changes.reserve(2*jobs.size());
+  for(const Job& job : jobs) {
+    Time time = job.starting_time.value();
+    Time end_time = checked_add(time, job.processing_time);
+    Machine_Change required_machines = static_cast<Machine_Change>(job.required_machines);
+    changes.push_back(Gap{time,     static_cast<Machine_Change>(-required_machines)});
+    changes.push_back(Gap{end_time, required_machines});
+
+    if(makespan < end_time)
+      makespan = end_time;
+  }
+  add_additional_machines(changes);
+}
+
+// adds all changes of available machines at once (changes do not need to be sorted)
+template<typename Gaps>
+void Basic_Gap_Manager<Gaps>::add_additional_machines(vector<Gap> changes) {
+  auto by_time = [](const Gap& g1, const Gap& g2) { return g1.time < g2.time; };
+  if(!is_sorted(changes.begin(), changes.end(), by_time))
+    sort(changes.begin(), changes.end(), by_time);
+
+  // merge changes at the same time, so each time is updated only once
+  size_t i = 0;
+  while(i < changes.size()) {
+    Time time = changes[i].time;
+    Machine_Change additional_machines = 0;
+    for(; i < changes.size() && changes[i].time == time; i++)
+      additional_machines += changes[i].additional_machines;
+
+    if(additional_machines != 0)
+      add_additional_machines_at(time, additional_machines);
+  }
+}
+
+// frees the machines of all jobs (at their starting times) in one pass over the gaps
+// entries which become zero are erased and the makespan is lowered to the end of the remaining jobs
+template<typename Gaps>
+void Basic_Gap_Manager<Gaps>::remove_jobs(const Job_List& jobs) {
+  if(jobs.empty())
+    return;
+
+  vector<Gap> changes;
+  changes.reserve(2*jobs.size());
+  for(const Job& job : jobs) {
+    Time time = job.starting_time.value();
+    Time end_time = checked_add(time, job.processing_time);
+    Machine_Change required_machines = static_cast<Machine_Change>(job.required_machines);
+    changes.push_back(Gap{time,     required_machines});
+    changes.push_back(Gap{end_time, static_cast<Machine_Change>(-required_machines)});
+  }
+  sort(changes.begin(), changes.end(), [](const Gap& g1, const Gap& g2) { return g1.time < g2.time; });
+
+  // merge the changes into the gaps in ascending order
+  auto it = gaps.begin();
+  size_t i = 0;
+  while(i < changes.size()) {
+    Time time = changes[i].time;
+    Machine_Change additional_machines = 0;
+    for(; i < changes.size() && changes[i].time == time; i++)
+      additional_machines += changes[i].additional_machines;
+
+    while(it != gaps.end() && it->first < time)
+      ++it;
+
+    // abutting jobs of the same width leave no entry at the time between them
+    if(it == gaps.end() || it->first != time)
+      it = gaps.insert({time, 0}).first;
+
+    if(current_time >= time)
+      available_machines_in_gap += additional_machines;
+
+    it->second += additional_machines;
+    if(it->second == 0 && time != 0)
+      it = gaps.erase(it);
+    else
+      changed_in_place(time);
+  }
+
+  // the last entry is the end of the highest remaining job (or 0)
+  if(!gaps.key_exists(makespan))
+    makespan = prev(gaps.end())->first;
+}
+
+template<typename Gaps>
+void Basic_Gap_Manager<Gaps>::remove_job_at(Job job, Time time) {
+  Time end_time = checked_add(time, job.processing_time);
+  add_additional_machines_at(time,     job.required_machines);
+  add_additional_machines_at(end_time, -job.required_machines);
+
+  // the last entry is the end of the highest remaining job (or 0)
+  if(!gaps.key_exists(makespan))
+    makespan = prev(gaps.end())->first;
+}
+
+template<typename Gaps>
+Time Basic_Gap_Manager<Gaps>::update_earliest_time_to_place(Job job) {
+  Gap_Cursor cursor = {current_time, available_machines_in_gap};
+  find_earliest_time_to_place(job, cursor);
+  current_time = cursor.time;
+  available_machines_in_gap = cursor.available_machines;
+  return current_time;
+}
+
+template<typename Gaps>
+Gap_Cursor Basic_Gap_Manager<Gaps>::get_start_cursor() const {
+  // the entry at time 0 always exists
+  return Gap_Cursor{0, static_cast<Machines>(gaps.begin()->second)};
+}
+
+template<typename Gaps>
+Time Basic_Gap_Manager<Gaps>::find_earliest_time_to_place(Job job, Gap_Cursor& cursor) const {
+  while(cursor.available_machines < job.required_machines) {
+    optional<Gap> opt_gap = gaps.get_next_gap(cursor.time+1);
     if(opt_gap.has_value()) {
       Gap gap = opt_gap.value();
-      current_time = gap.time;   
-      available_machines_in_gap += gap.additional_machines;
+      cursor.time = gap.time;
+      cursor.available_machines += gap.additional_machines;
     }
     else
       throw std::runtime_error("should never happen");
   }
-  return current_time;
+  return cursor.time;
+}
+
+// all machines are available after the last change, so the changes are summed up from the nearer end
+template<typename Gaps>
+Gap_Cursor Basic_Gap_Manager<Gaps>::get_cursor_at(Time time) const {
+  if constexpr (requires(const Gaps& tree) { tree.get_prefix_sum(time); })
+    return Gap_Cursor{time, static_cast<Machines>(gaps.get_prefix_sum(time))};
+
+  if(time < makespan/2) {
+    Machine_Change available_machines = 0;
+    for(auto it = gaps.begin(); it != gaps.end() && it->first <= time; ++it)
+      available_machines += it->second;
+    return Gap_Cursor{time, static_cast<Machines>(available_machines)};
+  }
+
+  Machine_Change changes_above = 0;
+  for(optional<Gap> opt_gap = gaps.get_next_gap(time+1); opt_gap.has_value(); opt_gap = gaps.get_next_gap(opt_gap->time+1))
+    changes_above += opt_gap->additional_machines;
+  return Gap_Cursor{time, static_cast<Machines>(m - changes_above)};
+}
+
+// the changes during the processing time are checked, the search goes on from the first one which is too small
+template<typename Gaps>
+Time Basic_Gap_Manager<Gaps>::find_earliest_time_to_fit(Job job, Gap_Cursor& cursor) const {
+  while(true) {
+    find_earliest_time_to_place(job, cursor);
+
+    Gap_Cursor probe = cursor;
+    bool fits = true;
+    for(optional<Gap> opt_gap = gaps.get_next_gap(probe.time+1);
+        opt_gap.has_value() && opt_gap->time < cursor.time + job.processing_time;
+        opt_gap = gaps.get_next_gap(probe.time+1)) {
+      probe.time = opt_gap->time;
+      probe.available_machines += opt_gap->additional_machines;
+      if(probe.available_machines < job.required_machines) {
+        fits = false;
+        break;
+      }
+    }
+
+    if(fits)
+      return cursor.time;
+    cursor = probe;
+  }
+}
+
+template<typename Gaps>
+Machines Basic_Gap_Manager<Gaps>::get_minimum_available_machines(Gap_Cursor cursor, Time end_time) const {
+  Machines minimum = cursor.available_machines;
+  for(optional<Gap> opt_gap = gaps.get_next_gap(cursor.time+1);
+      opt_gap.has_value() && opt_gap->time < end_time;
+      opt_gap = gaps.get_next_gap(opt_gap->time+1)) {
+    cursor.available_machines += opt_gap->additional_machines;
+    minimum = min(minimum, cursor.available_machines);
+  }
+  return minimum;
 }
 
 // transform relative gap structure to structure which absolute values
-// which means that in the new structure at time t the value of inv_absolute_gaps[t]
-// represents how many machines are available at that time 
+// which means that in the new structure the entry with time t
+// represents how many machines are available up to that time (since the previous entry)
 // (instead of how many available machines change at time t)
 // note that we will inverse the time since we move down
 // (so t=makespan is now 0 and t=0 is now makespan) 
-map<uint,uint> Gap_Manager::build_inverse_absolute_gaps() {
-  set_structure_to_top();
+// the entries are sorted increasingly by time
+template<typename Gaps>
+Absolute_Gap_List Basic_Gap_Manager<Gaps>::build_inverse_absolute_gaps() {
+  reset_structure();
+  return get_inverse_absolute_gaps();
+}
+
+// walks down from the top with a local cursor
+template<typename Gaps>
+Absolute_Gap_List Basic_Gap_Manager<Gaps>::get_inverse_absolute_gaps() const {
+  Gap_Cursor cursor = {makespan, m};
 
-  map<uint, uint> inverse_absolute_gaps;
-  inverse_absolute_gaps[0] = 0;
-  uint available_time = 0;
+  Absolute_Gap_List inverse_absolute_gaps;
+  inverse_absolute_gaps.reserve(gaps.size()+1);
+  Time available_time = 0;
   Gap previous_gap = Gap{makespan,0};
-  optional<Gap> opt_gap = Gap{makespan, gaps[makespan]};
+  auto makespan_it = gaps.find(makespan);
+  optional<Gap> opt_gap = Gap{makespan, makespan_it == gaps.end() ? Machine_Change(0) : makespan_it->second};
   while(opt_gap.has_value()) {
     Gap gap = opt_gap.value();
-    available_time += current_time - gap.time;
-    current_time = gap.time;
-    available_machines_in_gap -= previous_gap.additional_machines;
+    available_time += cursor.time - gap.time;
+    cursor.time = gap.time;
+    cursor.available_machines -= previous_gap.additional_machines;
 
-    inverse_absolute_gaps[available_time] = available_machines_in_gap;
+    inverse_absolute_gaps.push_back(Absolute_Gap{available_time, cursor.available_machines});
 
-    opt_gap = gaps.get_previous_gap(current_time);
+    opt_gap = gaps.get_previous_gap(cursor.time);
     previous_gap = gap;
   }
 
-  reset_structure();
-
   return inverse_absolute_gaps;
 }
 
-uint Gap_Manager::get_makespan() {
+template<typename Gaps>
+Time Basic_Gap_Manager<Gaps>::get_makespan() const {
   return makespan;
 }
 
+
+// moves the profile of other directly on top of this profile (starting at the makespan)
+// the gaps of other are spliced in as a whole, other is left without gaps
+template<typename Gaps>
+void Basic_Gap_Manager<Gaps>::stack_on_top(Basic_Gap_Manager& other) {
+  stack_gaps_on_top(other.get_gaps(), other.makespan);
+  other.gaps.clear();
+}
+
+// places the profile given by gaps (ascending in time, starting at time 0) 
+// and ending at height directly on top of this profile
+template<typename Gaps>
+void Basic_Gap_Manager<Gaps>::stack_gaps_on_top(const vector<Gap>& stacked_gaps, Time height) {
+  if(height == 0)
+    return;
+
+  Time offset = makespan;
+
+  // at the offset the stacked profile starts (instead of all m machines being available)
+  Machine_Change available_machines_at_offset = 0;
+  if(!stacked_gaps.empty() && stacked_gaps[0].time == 0)
+    available_machines_at_offset = stacked_gaps[0].additional_machines;
+  add_additional_machines_at(offset, available_machines_at_offset - static_cast<Machine_Change>(m));
+
+  // shift the remaining gaps in ascending order
+  vector<Gap> shifted_gaps;
+  shifted_gaps.reserve(stacked_gaps.size());
+  for(const Gap& gap : stacked_gaps) 
+    if(gap.time != 0 && gap.additional_machines != 0)
+      shifted_gaps.push_back(Gap{checked_add(gap.time, offset), gap.additional_machines});
+
+  // usually all shifted gaps are larger than the existing keys, then they are appended
+  // (the pb_ds tree joins a tree of them, the others insert at the end)
+  if(shifted_gaps.empty() || prev(gaps.end())->first < shifted_gaps.front().time) {
+    if constexpr (requires(Gaps& tree) { tree.join(tree); }) {
+      Gaps shifted_tree;
+      for(const Gap& gap : shifted_gaps)
+        shifted_tree.insert({gap.time, gap.additional_machines});
+      gaps.join(shifted_tree);
+    }
+    else
+      for(const Gap& gap : shifted_gaps)
+        gaps.insert(gaps.end(), {gap.time, gap.additional_machines});
+  }
+  else
+    for(const Gap& gap : shifted_gaps)
+      add_additional_machines_at(gap.time, gap.additional_machines);
+
+  // the structure below the offset is unchanged
+  if(current_time >= offset) {
+    current_time = offset;
+    available_machines_in_gap = available_machines_at_offset;
+  }
+
+  makespan = checked_add(offset, height);
+}
+
+template<typename Gaps>
+size_t Basic_Gap_Manager<Gaps>::get_number_of_gaps() const {
+  return gaps.size();
+}
+
+template<typename Gaps>
+vector<Gap> Basic_Gap_Manager<Gaps>::get_gaps() const {
+  vector<Gap> gap_list;
+  gap_list.reserve(gaps.size());
+  for(auto& [time, additional_machines] : gaps)
+    gap_list.push_back(Gap{time, additional_machines});
+  return gap_list;
+}
+
+// gaps of the profile rotated by 180 degrees
+// (the available machines at time t are the available machines of the original profile before makespan-t)
+template<typename Gaps>
+vector<Gap> Basic_Gap_Manager<Gaps>::get_rotated_gaps() const {
+  return rotate_gaps(get_gaps(), makespan, m);
+}
+
+template<typename Gaps>
+void Basic_Gap_Manager<Gaps>::changed_in_place(Time time) {
+  if constexpr (requires(Gaps& tree) { tree.update_sums_to(time); })
+    gaps.update_sums_to(time);
+}
+
+template class Basic_Gap_Manager<indexed_tree>;
+template class Basic_Gap_Manager<ordered_gap_map>;
+template class Basic_Gap_Manager<flat_gap_map>;
+template class Basic_Gap_Manager<summed_tree>;
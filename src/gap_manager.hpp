@@ -2,38 +2,144 @@
 #include "types.hpp"
 
 
-class Gap_Manager {
+// interface of the gap structure of a schedule
+// the schedules are instantiated for every structure, so there are no virtual calls on the hot path
+template<typename GM>
+concept Gap_Structure = requires(GM gap_manager, const GM const_gap_manager, Machines m,
+                                 Job job, Time time, const Job_List& jobs, const vector<Gap>& gaps,
+                                 Gap_Cursor& cursor) {
+  GM(m);
+  gap_manager.reset_structure();
+  gap_manager.set_structure_to_top();
+  gap_manager.place_job_at(job, time);
+  gap_manager.place_jobs(jobs);
+  gap_manager.remove_jobs(jobs);
+  gap_manager.remove_job_at(job, time);
+  { gap_manager.update_earliest_time_to_place(job) } -> same_as<Time>;
+  { const_gap_manager.get_start_cursor() } -> same_as<Gap_Cursor>;
+  { const_gap_manager.find_earliest_time_to_place(job, cursor) } -> same_as<Time>;
+  { const_gap_manager.get_cursor_at(time) } -> same_as<Gap_Cursor>;
+  { const_gap_manager.find_earliest_time_to_fit(job, cursor) } -> same_as<Time>;
+  { const_gap_manager.get_minimum_available_machines(cursor, time) } -> same_as<Machines>;
+  { const_gap_manager.get_inverse_absolute_gaps() } -> same_as<Absolute_Gap_List>;
+  { gap_manager.build_inverse_absolute_gaps() } -> same_as<Absolute_Gap_List>;
+  gap_manager.stack_on_top(gap_manager);
+  gap_manager.stack_gaps_on_top(gaps, time);
+  { const_gap_manager.get_makespan() } -> same_as<Time>;
+  { const_gap_manager.get_number_of_gaps() } -> same_as<size_t>;
+  { const_gap_manager.get_gaps() } -> same_as<vector<Gap>>;
+  { const_gap_manager.get_rotated_gaps() } -> same_as<vector<Gap>>;
+  // the cursor of update_earliest_time_to_place
+  gap_manager.current_time;
+  gap_manager.available_machines_in_gap;
+  gap_manager.makespan;
+};
+
+// gaps of a profile (ascending in time, starting at time 0) ending at makespan rotated by 180 degrees
+// (the available machines at time t are the available machines of the original profile before makespan-t)
+vector<Gap> rotate_gaps(const vector<Gap>& gaps, Time makespan, Machines m);
+
+// stores the changes of available machines in an ordered map Gaps from time to change
+// (pb_ds tree, std::map or sorted vector)
+template<typename Gaps>
+class Basic_Gap_Manager {
 public:
-  uint m;
+  Machines m;
 
-  Gap_Manager(uint m);
+  Basic_Gap_Manager(Machines m);
+
+  virtual ~Basic_Gap_Manager() = default;
 
   void reset_structure();
 
   void set_structure_to_top();
 
-  void place_job_at(Job job, uint time);
+  void place_job_at(Job job, Time time);
+
+  // an entry whose change becomes zero is erased (except the one at time 0)
+  void add_additional_machines_at(Time time, Machine_Change additional_machines);
+
+  // places all jobs at their starting times with one update per distinct time
+  void place_jobs(const Job_List& jobs);
+
+  // adds all changes of available machines at once (changes do not need to be sorted)
+  void add_additional_machines(vector<Gap> changes);
+
+  // frees the machines of all jobs (at their starting times) in one pass over the gaps
+  // entries which become zero are erased and the makespan is lowered to the end of the remaining jobs
+  void remove_jobs(const Job_List& jobs);
+
+  // frees the machines of one job placed at time (only the two entries of the job are touched)
+  void remove_job_at(Job job, Time time);
+
+  // moves the cursor of the manager (see find_earliest_time_to_place)
+  Time update_earliest_time_to_place(Job job);
+
+  // cursor at time 0
+  Gap_Cursor get_start_cursor() const;
 
-  void add_additional_machines_at(uint time, uint additional_machines);
-  
-  uint update_earliest_time_to_place(Job job);
+  // moves cursor up to the earliest time (not before cursor.time) where job has enough machines
+  // and returns that time, the structure is not changed
+  Time find_earliest_time_to_place(Job job, Gap_Cursor& cursor) const;
+
+  // cursor at time, logarithmic with the sums of Summed_Gap_Manager
+  // (the other structures sum up the changes below or above time, so it is cheap near both ends)
+  Gap_Cursor get_cursor_at(Time time) const;
+
+  // as find_earliest_time_to_place, but job has enough machines during its whole processing time
+  // (find_earliest_time_to_place only looks at the starting time)
+  Time find_earliest_time_to_fit(Job job, Gap_Cursor& cursor) const;
+
+  // fewest available machines in [cursor.time, end_time)
+  Machines get_minimum_available_machines(Gap_Cursor cursor, Time end_time) const;
 
   // transform relative gap structure to structure which absolute values
-  // which means that in the new structure at time t the value of inv_absolute_gaps[t]
-  // represents how many machines are available at that time 
+  // which means that in the new structure the entry with time t
+  // represents how many machines are available up to that time (since the previous entry)
   // (instead of how many available machines change at time t)
   // note that we will inverse the time since we move down
-  // (so t=makespan is now 0 and t=0 is now makespan) 
-  virtual map<uint,uint> build_inverse_absolute_gaps();
+  // (so t=makespan is now 0 and t=0 is now makespan)
+  // the entries are sorted increasingly by time
+  // resets the cursor of the manager
+  // (virtual to be mocked, it is called once per schedule_down)
+  virtual Absolute_Gap_List build_inverse_absolute_gaps();
+
+  // build_inverse_absolute_gaps without touching the cursor of the manager
+  Absolute_Gap_List get_inverse_absolute_gaps() const;
+
+  Time get_makespan() const;
+
+  // moves the profile of other directly on top of this profile (starting at the makespan)
+  // the gaps of other are spliced in as a whole, other is left without gaps
+  void stack_on_top(Basic_Gap_Manager& other);
 
-  uint get_makespan();
+  // places the profile given by gaps (ascending in time, starting at time 0)
+  // and ending at height directly on top of this profile
+  void stack_gaps_on_top(const vector<Gap>& stacked_gaps, Time height);
+
+  size_t get_number_of_gaps() const;
+
+  vector<Gap> get_gaps() const;
+
+  // gaps of the profile rotated by 180 degrees
+  // (the available machines at time t are the available machines of the original profile before makespan-t)
+  vector<Gap> get_rotated_gaps() const;
 
 /* private: */
-  indexed_tree gaps;
+  Gaps gaps;
+
+  // the change at time was written through an iterator (the tree updates its sums)
+  void changed_in_place(Time time);
 
   // next index in gap_start to consider
-  uint current_time;                  
-  uint available_machines_in_gap;
+  Time current_time;
+  Machines available_machines_in_gap;
 
-  uint makespan;
+  Time makespan;
 };
+
+typedef Basic_Gap_Manager<indexed_tree> Gap_Manager;
+typedef Basic_Gap_Manager<ordered_gap_map> Map_Gap_Manager;
+typedef Basic_Gap_Manager<flat_gap_map> Flat_Gap_Manager;
+// opt-in for schedules with many cancel_job calls: get_cursor_at is logarithmic (see summed_tree)
+typedef Basic_Gap_Manager<summed_tree> Summed_Gap_Manager;
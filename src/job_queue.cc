@@ -0,0 +1,164 @@
+#include "job_queue.hpp"
+
+#include <bit>
+
+// cell i is free for the push at position p if its sequence is p, and filled for the pop at p if it is p+1
+Job_Queue::Job_Queue(size_t capacity)
+    : cells(new Cell[bit_ceil(max<size_t>(capacity, 2))]), mask(bit_ceil(max<size_t>(capacity, 2)) - 1),
+      push_position(0), pop_position(0)
+  {
+    for(size_t i = 0; i <= mask; i++)
+      cells[i].sequence.store(i, memory_order_relaxed);
+  }
+
+bool Job_Queue::try_push(const Job& job, Submission_Time submission_time) {
+  size_t position = push_position.load(memory_order_relaxed);
+  Cell* cell;
+  while(true) {
+    cell = &cells[position & mask];
+    size_t sequence = cell->sequence.load(memory_order_acquire);
+    intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+    if(difference == 0) {
+      if(push_position.compare_exchange_weak(position, position+1, memory_order_relaxed))
+        break;
+    }
+    // the cell was not popped yet since the last round
+    else if(difference < 0)
+      return false;
+    else
+      position = push_position.load(memory_order_relaxed);
+  }
+
+  cell->job = job;
+  cell->submission_time = submission_time;
+  cell->sequence.store(position+1, memory_order_release);
+  return true;
+}
+
+bool Job_Queue::try_pop(Job& job, Submission_Time& submission_time) {
+  size_t position = pop_position.load(memory_order_relaxed);
+  Cell* cell;
+  while(true) {
+    cell = &cells[position & mask];
+    size_t sequence = cell->sequence.load(memory_order_acquire);
+    intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position+1);
+    if(difference == 0) {
+      if(pop_position.compare_exchange_weak(position, position+1, memory_order_relaxed))
+        break;
+    }
+    // the cell was not pushed yet
+    else if(difference < 0)
+      return false;
+    else
+      position = pop_position.load(memory_order_relaxed);
+  }
+
+  job = cell->job;
+  submission_time = cell->submission_time;
+  cell->sequence.store(position+mask+1, memory_order_release);
+  return true;
+}
+
+size_t Job_Queue::get_depth() const {
+  size_t pushed = push_position.load(memory_order_relaxed);
+  size_t popped = pop_position.load(memory_order_relaxed);
+  return pushed > popped ? pushed - popped : 0;
+}
+
+size_t Job_Queue::get_capacity() const {
+  return mask+1;
+}
+
+Job_Batcher::Job_Batcher(size_t capacity, const Batching_Policy& policy, function<void(const Job_List&)> schedule_batch)
+    : queue(capacity), policy(policy), schedule_batch(schedule_batch),
+      stopping(false), finishing(false), running_submissions(0), submitted_jobs(0), rejected_jobs(0),
+      batches(0), scheduled_jobs(0), max_queue_depth(0),
+      total_batching_latency_ns(0), max_batching_latency_ns(0), total_scheduling_ns(0),
+      consumer(&Job_Batcher::consume, this)
+  {}
+
+Job_Batcher::~Job_Batcher() {
+  stop();
+}
+
+bool Job_Batcher::submit(const Job& job) {
+  running_submissions.fetch_add(1);
+  bool submitted = !stopping.load() && queue.try_push(job, chrono::steady_clock::now());
+  running_submissions.fetch_sub(1);
+
+  (submitted ? submitted_jobs : rejected_jobs).fetch_add(1, memory_order_relaxed);
+  return submitted;
+}
+
+void Job_Batcher::stop() {
+  if(stopping.exchange(true))
+    return;
+
+  // a submission which saw stopping=false is in the queue afterwards
+  while(running_submissions.load() != 0)
+    this_thread::yield();
+  finishing.store(true);
+  consumer.join();
+}
+
+Batcher_Metrics Job_Batcher::get_metrics() const {
+  unsigned long long number_of_batches = batches.load();
+  auto to_ms = [](long long ns) { return ns / 1e6; };
+  return Batcher_Metrics{
+    submitted_jobs.load(), rejected_jobs.load(), number_of_batches, scheduled_jobs.load(),
+    queue.get_depth(), max_queue_depth.load(),
+    number_of_batches == 0 ? 0.0 : to_ms(total_batching_latency_ns.load()) / number_of_batches,
+    to_ms(max_batching_latency_ns.load()),
+    number_of_batches == 0 ? 0.0 : to_ms(total_scheduling_ns.load()) / number_of_batches
+  };
+}
+
+void Job_Batcher::consume() {
+  Job_List batch;
+  batch.reserve(policy.max_batch_size);
+  Submission_Time first_submission_time;
+
+  while(true) {
+    // read before the pop, so an empty queue afterwards is really the end
+    bool finished = finishing.load();
+
+    size_t depth = queue.get_depth();
+    if(depth > max_queue_depth.load(memory_order_relaxed))
+      max_queue_depth.store(depth, memory_order_relaxed);
+
+    Job job(0, 0);
+    Submission_Time submission_time;
+    bool popped = queue.try_pop(job, submission_time);
+    if(popped) {
+      if(batch.empty())
+        first_submission_time = submission_time;
+      batch.push_back(job);
+    }
+
+    // a late batch still takes the jobs which are queued already (otherwise a backlog would be scheduled job by job)
+    bool full = batch.size() >= policy.max_batch_size;
+    bool late = !popped && !batch.empty() && chrono::steady_clock::now() - first_submission_time >= policy.max_delay;
+    if(full || late || (!popped && finished && !batch.empty()))
+      schedule(batch, first_submission_time);
+    else if(!popped && finished)
+      return;
+    else if(!popped)
+      this_thread::sleep_for(policy.idle_sleep);
+  }
+}
+
+void Job_Batcher::schedule(Job_List& batch, Submission_Time first_submission_time) {
+  auto start = chrono::steady_clock::now();
+  long long batching_latency = chrono::duration_cast<chrono::nanoseconds>(start - first_submission_time).count();
+
+  schedule_batch(batch);
+
+  long long scheduling_time = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+  batches.fetch_add(1, memory_order_relaxed);
+  scheduled_jobs.fetch_add(batch.size(), memory_order_relaxed);
+  total_batching_latency_ns.fetch_add(batching_latency, memory_order_relaxed);
+  if(batching_latency > max_batching_latency_ns.load(memory_order_relaxed))
+    max_batching_latency_ns.store(batching_latency, memory_order_relaxed);
+  total_scheduling_ns.fetch_add(scheduling_time, memory_order_relaxed);
+  batch.clear();
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+typedef chrono::steady_clock::time_point Submission_Time;
+
+// bounded lock-free queue of jobs for any number of producers and consumers
+// (ring buffer with a sequence number per cell, as by Vyukov), the capacity is rounded up to a power of two
+// neither push nor pop ever waits, they fail if the queue is full or empty
+class Job_Queue {
+public:
+  Job_Queue(size_t capacity);
+
+  bool try_push(const Job& job, Submission_Time submission_time);
+
+  bool try_pop(Job& job, Submission_Time& submission_time);
+
+  // only exact if no other thread pushes or pops at the same time
+  size_t get_depth() const;
+
+  size_t get_capacity() const;
+
+private:
+  struct Cell {
+    atomic<size_t> sequence;
+    Job job = Job(0, 0);
+    Submission_Time submission_time;
+  };
+
+  unique_ptr<Cell[]> cells;
+  size_t mask;
+
+  // producers and consumers work on different cache lines
+  alignas(64) atomic<size_t> push_position;
+  alignas(64) atomic<size_t> pop_position;
+};
+
+// a batch is scheduled once it has max_batch_size jobs or its first job waited max_delay
+struct Batching_Policy {
+  size_t max_batch_size;
+  chrono::microseconds max_delay;
+  // the consumer sleeps this long when the queue is empty
+  chrono::microseconds idle_sleep;
+};
+
+const Batching_Policy DEFAULT_BATCHING_POLICY = {
+  /*max_batch_size=*/10000,
+  /*max_delay=*/chrono::milliseconds(5),
+  /*idle_sleep=*/chrono::microseconds(50)
+};
+
+struct Batcher_Metrics {
+  unsigned long long submitted_jobs;
+  // submissions which failed because the queue was full
+  unsigned long long rejected_jobs;
+  unsigned long long batches;
+  unsigned long long scheduled_jobs;
+  size_t queue_depth;
+  // largest depth the consumer saw
+  size_t max_queue_depth;
+  // from the submission of the first job of a batch until the batch is handed to the scheduler
+  double average_batching_latency_ms;
+  double max_batching_latency_ms;
+  double average_scheduling_ms;
+};
+
+// submitters push into a Job_Queue, one consumer thread collects the jobs into batches
+// and calls schedule_batch with them (e.g. Tower_Schedule::add_jobs), so submitters never wait for a schedule
+class Job_Batcher {
+public:
+  Job_Batcher(size_t capacity, const Batching_Policy& policy, function<void(const Job_List&)> schedule_batch);
+
+  // schedules the jobs which are still queued
+  ~Job_Batcher();
+
+  // false if the queue is full, never blocks
+  bool submit(const Job& job);
+
+  // schedules the queued jobs and stops the consumer (submissions afterwards are rejected)
+  void stop();
+
+  Batcher_Metrics get_metrics() const;
+
+private:
+  Job_Queue queue;
+  Batching_Policy policy;
+  function<void(const Job_List&)> schedule_batch;
+
+  // stopping rejects new submissions, finishing lets the consumer end once the queue is empty
+  // (stop waits in between until no submission is running anymore)
+  atomic<bool> stopping;
+  atomic<bool> finishing;
+  atomic<uint> running_submissions;
+  atomic<unsigned long long> submitted_jobs;
+  atomic<unsigned long long> rejected_jobs;
+  // written by the consumer only
+  atomic<unsigned long long> batches;
+  atomic<unsigned long long> scheduled_jobs;
+  atomic<size_t> max_queue_depth;
+  atomic<long long> total_batching_latency_ns;
+  atomic<long long> max_batching_latency_ns;
+  atomic<long long> total_scheduling_ns;
+
+  thread consumer;
+
+  void consume();
+
+  void schedule(Job_List& batch, Submission_Time first_submission_time);
+};
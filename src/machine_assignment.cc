@@ -0,0 +1,160 @@
+#include "machine_assignment.hpp"
+
+#include <queue>
+#include <numeric>
+
+size_t Machine_Assignment::get_number_of_jobs() const {
+  return first_range.empty() ? 0 : first_range.size()-1;
+}
+
+size_t Machine_Assignment::get_number_of_ranges(uint job) const {
+  return first_range[job+1] - first_range[job];
+}
+
+const Machine_Range* Machine_Assignment::get_ranges(uint job) const {
+  return ranges.data() + first_range[job];
+}
+
+size_t Machine_Assignment::get_number_of_fragmented_jobs() const {
+  size_t fragmented_jobs = 0;
+  for(uint job = 0; job < get_number_of_jobs(); job++)
+    if(get_number_of_ranges(job) > 1)
+      fragmented_jobs++;
+  return fragmented_jobs;
+}
+
+// maximal ranges of free machines, by first machine and by size
+class Free_Machines {
+public:
+  Free_Machines(Machines m) : free_machines(m) {
+    if(m > 0)
+      insert(Machine_Range{0, m});
+  }
+
+  // appends the taken ranges to taken_ranges
+  void take(Machines count, Machine_Assignment_Mode mode, vector<Machine_Range>& taken_ranges) {
+    if(count > free_machines)
+      throw runtime_error("the jobs need more than m machines");
+    free_machines -= count;
+
+    if(mode == Machine_Assignment_Mode::contiguous) {
+      auto smallest_fitting = by_size.lower_bound({count, 0});
+      if(smallest_fitting != by_size.end()) {
+        taken_ranges.push_back(take_from(smallest_fitting->second, count));
+        return;
+      }
+    }
+
+    while(count > 0) {
+      Machines first_machine = mode == Machine_Assignment_Mode::contiguous ? prev(by_size.end())->second
+                                                                           : by_first_machine.begin()->first;
+      Machine_Range range = take_from(first_machine, count);
+      count -= range.count;
+      taken_ranges.push_back(range);
+    }
+  }
+
+  // the range is merged with its free neighbours
+  void release(Machine_Range range) {
+    free_machines += range.count;
+
+    auto next = by_first_machine.lower_bound(range.first_machine);
+    if(next != by_first_machine.begin()) {
+      auto previous = prev(next);
+      if(previous->first + previous->second == range.first_machine) {
+        range = Machine_Range{previous->first, static_cast<Machines>(previous->second + range.count)};
+        erase(previous);
+      }
+    }
+    if(next != by_first_machine.end() && range.first_machine + range.count == next->first) {
+      range.count += next->second;
+      erase(next);
+    }
+    insert(range);
+  }
+
+private:
+  Machines free_machines;
+  map<Machines, Machines> by_first_machine;
+  set<pair<Machines, Machines>> by_size;
+
+  void insert(Machine_Range range) {
+    by_first_machine.emplace(range.first_machine, range.count);
+    by_size.emplace(range.count, range.first_machine);
+  }
+
+  void erase(map<Machines, Machines>::iterator range) {
+    by_size.erase({range->second, range->first});
+    by_first_machine.erase(range);
+  }
+
+  // takes at most count machines from the front of the free range starting at first_machine
+  Machine_Range take_from(Machines first_machine, Machines count) {
+    auto range = by_first_machine.find(first_machine);
+    Machines range_count = range->second;
+    erase(range);
+
+    Machines taken = min(count, range_count);
+    if(taken < range_count)
+      insert(Machine_Range{static_cast<Machines>(first_machine + taken), static_cast<Machines>(range_count - taken)});
+    return Machine_Range{first_machine, taken};
+  }
+};
+
+Machine_Assignment assign_machines(const Job_List& placed_jobs, Machines m, Machine_Assignment_Mode mode) {
+  uint n = placed_jobs.size();
+
+  vector<uint> order(n);
+  iota(order.begin(), order.end(), 0);
+  stable_sort(order.begin(), order.end(), [&](uint j1, uint j2) {
+    return placed_jobs[j1].starting_time.value() < placed_jobs[j2].starting_time.value();
+  });
+
+  // ranges in the order of the sweep, the ranges of job i are job_ranges[first_job_range[i]...]
+  vector<Machine_Range> job_ranges;
+  vector<size_t> first_job_range(n), number_of_job_ranges(n, 0);
+
+  // running jobs by completion time
+  typedef pair<Time_Difference, uint> Completion;
+  priority_queue<Completion, vector<Completion>, greater<Completion>> running_jobs;
+
+  Free_Machines free_machines(m);
+  for(uint job : order) {
+    Time_Difference starting_time = placed_jobs[job].starting_time.value();
+    while(!running_jobs.empty() && running_jobs.top().first <= starting_time) {
+      uint finished_job = running_jobs.top().second;
+      running_jobs.pop();
+      for(size_t i = 0; i < number_of_job_ranges[finished_job]; i++)
+        free_machines.release(job_ranges[first_job_range[finished_job]+i]);
+    }
+
+    first_job_range[job] = job_ranges.size();
+    free_machines.take(placed_jobs[job].required_machines, mode, job_ranges);
+    number_of_job_ranges[job] = job_ranges.size() - first_job_range[job];
+    sort(job_ranges.begin() + first_job_range[job], job_ranges.end(), [](const Machine_Range& r1, const Machine_Range& r2) {
+      return r1.first_machine < r2.first_machine;
+    });
+
+    running_jobs.push({starting_time + placed_jobs[job].processing_time, job});
+  }
+
+  // the ranges are reordered by job id
+  Machine_Assignment assignment;
+  assignment.first_range.resize(n+1, 0);
+  assignment.ranges.reserve(job_ranges.size());
+  for(uint job = 0; job < n; job++) {
+    assignment.first_range[job] = assignment.ranges.size();
+    assignment.ranges.insert(assignment.ranges.end(), job_ranges.begin() + first_job_range[job],
+                             job_ranges.begin() + first_job_range[job] + number_of_job_ranges[job]);
+  }
+  assignment.first_range[n] = assignment.ranges.size();
+  return assignment;
+}
+
+void write_machine_assignment(ostream& out, const Machine_Assignment& assignment) {
+  for(uint job = 0; job < assignment.get_number_of_jobs(); job++) {
+    const Machine_Range* ranges = assignment.get_ranges(job);
+    for(size_t i = 0; i < assignment.get_number_of_ranges(job); i++)
+      out << job << " " << ranges[i].first_machine << " " << ranges[i].count << "\n";
+  }
+}
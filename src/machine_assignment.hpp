@@ -0,0 +1,42 @@
+#pragma once
+
+#include "types.hpp"
+
+// machines first_machine, ..., first_machine+count-1
+struct Machine_Range {
+  Machines first_machine;
+  Machines count;
+};
+
+// concrete machines of the placed jobs of a schedule (the job id is the index in placed_jobs)
+// the ranges of job i are ranges[first_range[i]], ..., ranges[first_range[i+1]-1] (sorted by first_machine)
+struct Machine_Assignment {
+  vector<size_t> first_range;
+  vector<Machine_Range> ranges;
+
+  size_t get_number_of_jobs() const;
+
+  size_t get_number_of_ranges(uint job) const;
+
+  const Machine_Range* get_ranges(uint job) const;
+
+  // jobs which do not run on one contiguous range of machines
+  size_t get_number_of_fragmented_jobs() const;
+};
+
+enum class Machine_Assignment_Mode {
+  // a job takes the free machines with the lowest indices
+  first_fit,
+  // a job takes the smallest free range which holds all of its machines,
+  // if there is none it takes the largest free ranges
+  contiguous
+};
+
+// sweeps over the starting and completion times of the jobs, the free machines are kept as ranges
+// a job gets the machines which its predecessors released at or before its starting time
+// O((n + r) log n) with r the number of ranges, throws if the jobs need more than m machines at some time
+Machine_Assignment assign_machines(const Job_List& placed_jobs, Machines m,
+                                   Machine_Assignment_Mode mode = Machine_Assignment_Mode::first_fit);
+
+// one line "job first_machine count" per range
+void write_machine_assignment(ostream& out, const Machine_Assignment& assignment);
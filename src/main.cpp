@@ -3,11 +3,16 @@
 #include "schedule.hpp"
 #include "tower_schedule.hpp"
 #include "mcs.hpp"
+#include "gap_backend.hpp"
+#include "service.hpp"
+#include "streaming.hpp"
 
 #include <random>
 #include <chrono>
 #include <fstream>
 #include <filesystem>
+#include <thread>
+#include <unistd.h>
 
 using namespace std;
 namespace fs = std::filesystem;
@@ -19,24 +24,25 @@ void save_instance(const Job_List& jobs, const string& filename) {
   }
 }
 
-Job_List load_instance(const string& filename) {
-  Job_List jobs;
+// the values are read with 64 bits and checked against the widths of this build
+Job_List load_instance(const string& filename, Machines m) {
+  vector<Raw_Job> raw_jobs;
   ifstream in(filename);
-  uint processing_time, required_machines;
+  unsigned long long processing_time, required_machines;
   while (in >> processing_time >> required_machines) {
-    jobs.push_back(Job(processing_time, required_machines));
+    raw_jobs.push_back({processing_time, required_machines});
   }
-  return jobs;
+  return make_checked_jobs(raw_jobs, m);
 }
 
-Job_List generate_random_jobs(uint n, uint m, uint p_min = 1, uint p_max = 100) {
+Job_List generate_random_jobs(uint n, Machines m, Time p_min = 1, Time p_max = 100) {
   Job_List jobs;
   jobs.reserve(n);
 
   random_device rd;
   mt19937 gen(rd());
-  uniform_int_distribution<uint> dist_time(p_min, p_max);
-  uniform_int_distribution<uint> dist_machines(1, m);
+  uniform_int_distribution<Time> dist_time(p_min, p_max);
+  uniform_int_distribution<Machines> dist_machines(1, m);
 
   for(uint i = 0; i < n; ++i) {
     jobs.emplace_back(dist_time(gen), dist_machines(gen));
@@ -44,12 +50,98 @@ Job_List generate_random_jobs(uint n, uint m, uint p_min = 1, uint p_max = 100)
   return jobs;
 }
 
-int main() {
-  uint m = 100000;
-  uint p_max = 100;
+// program --serve <socket path> [--workers <k>] [--calibrate]
+// program --stdio [--calibrate]
+// the thresholds of the backends are measured once (with --calibrate) and kept for all requests
+int serve(int argc, char** argv) {
+  string socket_path;
+  bool use_stdio = false, calibrate = false;
+  uint workers = max(thread::hardware_concurrency(), 1u);
+  for(int i = 1; i < argc; i++) {
+    string argument = argv[i];
+    if(argument == "--serve" && i+1 < argc)
+      socket_path = argv[++i];
+    else if(argument == "--workers" && i+1 < argc)
+      workers = stoul(argv[++i]);
+    else if(argument == "--stdio")
+      use_stdio = true;
+    else if(argument == "--calibrate")
+      calibrate = true;
+    else {
+      cerr << "usage: " << argv[0] << " [--serve <socket path> [--workers <k>] | --stdio] [--calibrate]" << endl;
+      return 1;
+    }
+  }
+
+  // calibrated with m=100000 like the benchmark (or the largest m of this build)
+  Machines calibration_m = static_cast<Machines>(min<unsigned long long>(100000, numeric_limits<Machine_Change>::max()));
+  Backend_Thresholds thresholds = calibrate ? calibrate_backend_thresholds(calibration_m, 100) : DEFAULT_BACKEND_THRESHOLDS;
+  try {
+    if(use_stdio)
+      serve_stream(STDIN_FILENO, STDOUT_FILENO, thresholds);
+    else
+      serve_unix_socket(socket_path, workers, thresholds);
+  }
+  catch(const exception& e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
+
+// program --stream <instance> <output> <m> [--memory <jobs>] [--temporary <directory>]
+// the starting times are written to output (see schedule_stream)
+int stream(int argc, char** argv) {
+  if(argc < 5) {
+    cerr << "usage: " << argv[0] << " --stream <instance> <output> <m> [--memory <jobs>] [--temporary <directory>]" << endl;
+    return 1;
+  }
+  Streaming_Options options = DEFAULT_STREAMING_OPTIONS;
+  for(int i = 5; i < argc; i++) {
+    string argument = argv[i];
+    if(argument == "--memory" && i+1 < argc)
+      options.max_jobs_in_memory = stoull(argv[++i]);
+    else if(argument == "--temporary" && i+1 < argc)
+      options.temporary_directory = argv[++i];
+    else {
+      cerr << "unknown argument " << argument << endl;
+      return 1;
+    }
+  }
+
+  try {
+    unsigned long long m = stoull(argv[4]);
+    if(get_required_machine_bits(m) > PTS_MACHINE_BITS)
+      throw out_of_range("m needs " + to_string(get_required_machine_bits(m)) + " bit machines");
+    Streaming_Report report = schedule_stream(argv[2], argv[3], static_cast<Machines>(m), options);
+    cout << "n: " << report.n << ", slices: " << report.slices << endl;
+    cout << "makespan: " << report.makespan << ", ratio is at most " << report.ratio << endl;
+  }
+  catch(const exception& e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
+
+// program [--calibrate]
+// schedules the benchmark instances (they are generated if they do not exist yet)
+int benchmark(bool calibrate) {
+  unsigned long long benchmark_m = 100000;
+  if(get_required_machine_bits(benchmark_m) > PTS_MACHINE_BITS) {
+    cerr << "the benchmark needs " << get_required_machine_bits(benchmark_m) << " bit machines" << endl;
+    return 1;
+  }
+  Machines m = static_cast<Machines>(benchmark_m);
+  Time p_max = 100;
+
+  // thresholds of the gap structures, measured for this machine with --calibrate
+  Backend_Thresholds thresholds = calibrate ? calibrate_backend_thresholds(m, p_max) : DEFAULT_BACKEND_THRESHOLDS;
+  cout << "flat up to " << thresholds.flat_max_jobs << " jobs, dense up to makespan " << thresholds.dense_max_makespan
+       << ", otherwise " << get_backend_name(thresholds.tree_backend) << endl << endl;
 
   std::ofstream data_file("benchmark/benchmark_results.csv");
-  data_file << "n,time_ms,makespan\n"; 
+  data_file << "n,time_ms,makespan,gaps,backend\n"; 
 
   for (uint n = 100; n <= 100000; n += 100) {
     // load/create jobs
@@ -57,32 +149,51 @@ int main() {
     Job_List jobs;
     if (fs::exists(instance_path)) {
       cout << "Load existing file: n=" << n << "..." << flush;
-      jobs = load_instance(instance_path);
+      jobs = load_instance(instance_path, m);
     } else {
       cout << "Generate new instance: n=" << n << "..." << flush;
       jobs = generate_random_jobs(n, m, 1, p_max);
       save_instance(jobs, instance_path);
     }
 
-    Tower_Schedule tower_schedule(m, n);
-
-    // measure time of the function
-    auto start = std::chrono::high_resolution_clock::now();
-    tower_schedule.schedule_jobs(jobs);
-    auto end = std::chrono::high_resolution_clock::now();
-
-    std::chrono::duration<double, std::milli> duration = end - start;
-    double makespan = tower_schedule.sigma.get_makespan();
-
-    // write to file
-    data_file << n << "," << duration.count() << "," << makespan << "\n";
-
-    // log
-    cout << "took " << duration.count() << " ms" << endl;
-    cout << "makespan: " << tower_schedule.sigma.get_makespan() << endl;
-    cout << "ratio is at least " << tower_schedule.sigma.get_makespan()/tower_schedule.sigma.calculate_makespan_lower_bound(p_max) << endl << endl;
+    Gap_Backend backend = select_backend(jobs, m, thresholds);
+    with_tower_schedule(backend, m, n, [&](auto& tower_schedule) {
+      // measure time of the function
+      auto start = std::chrono::high_resolution_clock::now();
+      tower_schedule.schedule_jobs(jobs);
+      auto end = std::chrono::high_resolution_clock::now();
+
+      std::chrono::duration<double, std::milli> duration = end - start;
+      double makespan = tower_schedule.sigma.get_makespan();
+      size_t number_of_gaps = tower_schedule.sigma.gap_manager->get_number_of_gaps();
+
+      // write to file
+      data_file << n << "," << duration.count() << "," << makespan << "," << number_of_gaps << "," << get_backend_name(backend) << "\n";
+
+      // log
+      cout << "took " << duration.count() << " ms (" << get_backend_name(backend) << ")" << endl;
+      cout << "makespan: " << tower_schedule.sigma.get_makespan() << endl;
+      cout << "gaps: " << number_of_gaps << endl;
+      cout << "ratio is at least " << tower_schedule.sigma.get_makespan()/tower_schedule.sigma.calculate_makespan_lower_bound(p_max) << endl << endl;
+    });
   }
 
   data_file.close();
   return 0;
 }
+
+int main(int argc, char** argv) {
+  string mode = argc > 1 ? argv[1] : "";
+  if(mode == "--serve" || mode == "--stdio")
+    return serve(argc, argv);
+  if(mode == "--stream")
+    return stream(argc, argv);
+  if(argc == 1 || (argc == 2 && mode == "--calibrate"))
+    return benchmark(/*calibrate=*/argc == 2);
+
+  cerr << "usage: " << argv[0] << " [--calibrate]" << endl
+       << "       " << argv[0] << " --serve <socket path> [--workers <k>] [--calibrate]" << endl
+       << "       " << argv[0] << " --stdio [--calibrate]" << endl
+       << "       " << argv[0] << " --stream <instance> <output> <m> [--memory <jobs>] [--temporary <directory>]" << endl;
+  return 1;
+}
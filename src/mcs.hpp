@@ -8,11 +8,11 @@
 
 class MCS_Scheduler {
 public:
-  uint m;
+  Machines m;
   uint n;
   uint N;
 
-  MCS_Scheduler(uint m, uint n, uint N)
+  MCS_Scheduler(Machines m, uint n, uint N)
     : m(m), n(n), N(N)
   {}
 
@@ -22,14 +22,14 @@ public:
     tower_schedule.schedule_jobs(jobs);
     
     uint i = N/3;
-    uint partition_height = tower_schedule.sigma.get_makespan() / (2*i+1);
+    Time partition_height = tower_schedule.sigma.get_makespan() / (2*i+1);
 
-    uint current_cut = partition_height;
+    Time current_cut = partition_height;
     uint current_cluster = 1;
 
     for(auto job : tower_schedule.sigma.placed_jobs) {
-      uint starting_time = job.starting_time.value();
-      uint completion_time = starting_time + job.processing_time;
+      Time starting_time = job.starting_time.value();
+      Time completion_time = starting_time + job.processing_time;
       if(completion_time <= current_cut) {
         if(starting_time > current_cut) {
           // use next cluster 
@@ -0,0 +1,65 @@
+#include "multi_start.hpp"
+
+#include <atomic>
+#include <random>
+#include <thread>
+
+Multi_Start_Result schedule_with_restarts(Machines m, const Job_List& jobs, uint restarts, uint threads, unsigned long long seed,
+                                          const Backend_Thresholds& thresholds) {
+  if(restarts == 0)
+    throw invalid_argument("need at least one restart");
+
+  Gap_Backend backend = select_backend(jobs, m, thresholds);
+  vector<Time> makespans(restarts);
+  atomic<uint> next_restart = 0;
+
+  // every worker keeps its best restart, they are compared by (makespan, restart) at the end
+  struct Best {
+    Tower_Result result;
+    uint restart;
+  };
+  vector<optional<Best>> best_of_worker(max(threads, 1u));
+  vector<exception_ptr> errors(best_of_worker.size());
+
+  auto work = [&](size_t worker) {
+    try {
+      Job_List shuffled_jobs;
+      for(uint k = next_restart++; k < restarts; k = next_restart++) {
+        shuffled_jobs = jobs;
+        if(k != 0) {
+          seed_seq restart_seed = {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32), k};
+          mt19937 gen(restart_seed);
+          shuffle(shuffled_jobs.begin(), shuffled_jobs.end(), gen);
+        }
+
+        Tower_Result result = schedule_with_backend(backend, m, shuffled_jobs);
+        makespans[k] = result.makespan;
+        optional<Best>& best = best_of_worker[worker];
+        if(!best.has_value() || make_pair(result.makespan, k) < make_pair(best->result.makespan, best->restart))
+          best = Best{move(result), k};
+      }
+    }
+    catch(...) {
+      errors[worker] = current_exception();
+    }
+  };
+
+  vector<thread> pool;
+  for(size_t worker = 1; worker < best_of_worker.size(); worker++)
+    pool.emplace_back(work, worker);
+  work(0);
+  for(thread& worker : pool)
+    worker.join();
+
+  for(const exception_ptr& error : errors)
+    if(error)
+      rethrow_exception(error);
+
+  optional<Best> best;
+  for(optional<Best>& candidate : best_of_worker)
+    if(candidate.has_value() && (!best.has_value()
+       || make_pair(candidate->result.makespan, candidate->restart) < make_pair(best->result.makespan, best->restart)))
+      best = move(candidate);
+
+  return Multi_Start_Result{move(best->result.placed_jobs), best->result.makespan, best->restart, makespans};
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "types.hpp"
+#include "gap_backend.hpp"
+
+// the ties of the tower schedule (equal keys in the sorts, the order of equal required machines in the job pool)
+// are broken by the order of the input, so a restart schedules the jobs in a shuffled order
+struct Multi_Start_Result {
+  Job_List placed_jobs;
+  Time makespan;
+  // restart 0 schedules the jobs in the given order
+  uint best_restart;
+  // makespan of every restart
+  vector<Time> makespans;
+};
+
+// runs the restarts on a pool of threads (each one takes the next restart until none is left)
+// the order of restart k only depends on seed and k, and the first restart with the shortest makespan is returned,
+// so the result does not depend on the number of threads
+Multi_Start_Result schedule_with_restarts(Machines m, const Job_List& jobs, uint restarts, uint threads, unsigned long long seed,
+                                          const Backend_Thresholds& thresholds = DEFAULT_BACKEND_THRESHOLDS);
@@ -0,0 +1,74 @@
+#include "portfolio.hpp"
+
+#include <chrono>
+#include <thread>
+
+string get_strategy_name(Portfolio_Strategy strategy) {
+  switch(strategy) {
+    case Portfolio_Strategy::list: return "list";
+    case Portfolio_Strategy::decreasing_required_machines: return "decreasing_required_machines";
+    case Portfolio_Strategy::decreasing_processing_time: return "decreasing_processing_time";
+    default: return "tower";
+  }
+}
+
+static Tower_Result run_strategy(Portfolio_Strategy strategy, Gap_Backend backend, Machines m, const Job_List& jobs) {
+  if(strategy == Portfolio_Strategy::tower)
+    return schedule_with_backend(backend, m, jobs);
+
+  return with_tower_schedule(backend, m, 0, [&](auto& tower_schedule) {
+    typedef typename decay_t<decltype(tower_schedule)>::Schedule Schedule;
+
+    Job_List ordered_jobs = jobs;
+    if(strategy == Portfolio_Strategy::decreasing_required_machines)
+      sort_jobs_decreasingly_by_required_machines(ordered_jobs);
+    else if(strategy == Portfolio_Strategy::decreasing_processing_time)
+      stable_sort(ordered_jobs.begin(), ordered_jobs.end(), [](const Job& j1, const Job& j2) {
+        return j1.processing_time > j2.processing_time;
+      });
+
+    Schedule sigma(m, jobs.size());
+    sigma.list_schedule(ordered_jobs);
+    return Tower_Result{sigma.placed_jobs, sigma.get_makespan(), backend};
+  });
+}
+
+Portfolio_Result schedule_portfolio(Machines m, const Job_List& jobs, const vector<Portfolio_Strategy>& strategies, const Backend_Thresholds& thresholds) {
+  if(strategies.empty())
+    throw invalid_argument("portfolio without strategies");
+
+  Gap_Backend backend = select_backend(jobs, m, thresholds);
+  vector<Tower_Result> results(strategies.size());
+  vector<Strategy_Report> reports(strategies.size());
+  vector<exception_ptr> errors(strategies.size());
+
+  // every thread writes only its own entries
+  auto run = [&](size_t i) {
+    try {
+      auto start = chrono::steady_clock::now();
+      results[i] = run_strategy(strategies[i], backend, m, jobs);
+      chrono::duration<double, milli> duration = chrono::steady_clock::now() - start;
+      reports[i] = Strategy_Report{strategies[i], results[i].makespan, duration.count()};
+    }
+    catch(...) {
+      errors[i] = current_exception();
+    }
+  };
+
+  vector<thread> threads;
+  for(size_t i = 1; i < strategies.size(); i++)
+    threads.emplace_back(run, i);
+  run(0);
+  for(thread& t : threads)
+    t.join();
+
+  for(const exception_ptr& error : errors)
+    if(error)
+      rethrow_exception(error);
+
+  size_t best = 0;
+  for(size_t i = 1; i < results.size(); i++)
+    if(results[i].makespan < results[best].makespan)
+      best = i;
+  return Portfolio_Result{move(results[best].placed_jobs), results[best].makespan, strategies[best], reports};
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "types.hpp"
+#include "gap_backend.hpp"
+
+// algorithms of the portfolio, all of them see the same jobs
+enum class Portfolio_Strategy {
+  tower,                          // tower schedule
+  list,                           // list schedule of the jobs in the given order
+  decreasing_required_machines,   // list schedule of the jobs sorted decreasingly by required machines
+  decreasing_processing_time      // list schedule of the jobs sorted decreasingly by processing time
+};
+
+string get_strategy_name(Portfolio_Strategy strategy);
+
+const vector<Portfolio_Strategy> DEFAULT_PORTFOLIO = {
+  Portfolio_Strategy::tower,
+  Portfolio_Strategy::list,
+  Portfolio_Strategy::decreasing_required_machines,
+  Portfolio_Strategy::decreasing_processing_time
+};
+
+struct Strategy_Report {
+  Portfolio_Strategy strategy;
+  Time makespan;
+  double elapsed_ms;
+};
+
+struct Portfolio_Result {
+  Job_List placed_jobs;
+  Time makespan;
+  Portfolio_Strategy strategy;
+  // in the order of the strategies
+  vector<Strategy_Report> reports;
+};
+
+// runs every strategy on its own thread (the first one on the calling thread) with the gap structure of select_backend
+// and returns the schedule with the shortest makespan (the earlier strategy on ties)
+// the wall time is the one of the slowest strategy if there is a core per strategy
+Portfolio_Result schedule_portfolio(Machines m, const Job_List& jobs, const vector<Portfolio_Strategy>& strategies = DEFAULT_PORTFOLIO, const Backend_Thresholds& thresholds = DEFAULT_BACKEND_THRESHOLDS);
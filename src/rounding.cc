@@ -0,0 +1,93 @@
+#include "rounding.hpp"
+
+#include <cmath>
+
+// the smallest ceil((1+epsilon)^k) which is at least value (for value >= 2)
+// the exponent is estimated and corrected upwards
+static double round_up_geometric(unsigned long long value, double epsilon) {
+  double base = 1 + epsilon;
+  double exponent = max(0.0, floor(log(static_cast<double>(value - 1)) / log(base)) - 1);
+  double rounded = ceil(pow(base, exponent) - 1e-9);
+  while(rounded < value)
+    rounded = ceil(pow(base, ++exponent) - 1e-9);
+  return rounded;
+}
+
+Time round_processing_time(Time processing_time, const Processing_Time_Rounding& rounding) {
+  if(processing_time <= 1)
+    return processing_time;
+
+  switch(rounding.mode) {
+    case Processing_Time_Rounding::geometric: {
+      if(rounding.epsilon <= 0)
+        return processing_time;
+      double rounded = round_up_geometric(processing_time, rounding.epsilon);
+      if(rounded >= static_cast<double>(INVALID_TIME))
+        throw overflow_error("rounded processing time does not fit into Time");
+      return static_cast<Time>(rounded);
+    }
+    case Processing_Time_Rounding::grid: {
+      if(rounding.grid_step <= 1)
+        return processing_time;
+      Time multiples = processing_time / rounding.grid_step + (processing_time % rounding.grid_step != 0);
+      return checked_multiply(multiples, rounding.grid_step);
+    }
+    default:
+      return processing_time;
+  }
+}
+
+// the bound of the class of q is the largest tiny/small/medium/big requirement (m/4, m/3, m/2, m)
+Machines round_required_machines(Machines required_machines, Machines m, const Machine_Rounding& rounding) {
+  if(required_machines <= 1)
+    return required_machines;
+
+  Machines class_bound = m;
+  if(4*static_cast<unsigned long long>(required_machines) <= m)
+    class_bound = m/4;
+  else if(3*static_cast<unsigned long long>(required_machines) <= m)
+    class_bound = m/3;
+  else if(2*static_cast<unsigned long long>(required_machines) <= m)
+    class_bound = m/2;
+
+  double rounded = required_machines;
+  switch(rounding.mode) {
+    case Machine_Rounding::geometric:
+      if(rounding.epsilon > 0)
+        rounded = round_up_geometric(required_machines, rounding.epsilon);
+      break;
+    case Machine_Rounding::grid: {
+      Machines step = rounding.classes == 0 ? 1 : max<Machines>(1, m / rounding.classes);
+      rounded = static_cast<double>(required_machines / step + (required_machines % step != 0)) * step;
+      break;
+    }
+    default:
+      break;
+  }
+  return static_cast<Machines>(min(rounded, static_cast<double>(class_bound)));
+}
+
+Job_List round_processing_times(Job_List jobs, const Processing_Time_Rounding& rounding) {
+  for(Job& job : jobs)
+    job.processing_time = round_processing_time(job.processing_time, rounding);
+  return jobs;
+}
+
+Job_List round_required_machines(Job_List jobs, Machines m, const Machine_Rounding& rounding) {
+  for(Job& job : jobs)
+    job.required_machines = round_required_machines(job.required_machines, m, rounding);
+  return jobs;
+}
+
+double get_makespan_lower_bound(const Job_List& jobs, Machines m) {
+  if(m == 0)
+    return 0.0;
+
+  long double total_area = 0;
+  Time p_max = 0;
+  for(const Job& job : jobs) {
+    total_area += static_cast<long double>(job.processing_time) * job.required_machines;
+    p_max = max(p_max, job.processing_time);
+  }
+  return max(static_cast<double>(total_area / m), static_cast<double>(p_max));
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "types.hpp"
+
+// opt-in approximation: processing times are rounded up to few distinct values,
+// so jobs share the breakpoints of the gaps (and identical jobs can be grouped)
+struct Processing_Time_Rounding {
+  enum Mode { none, geometric, grid };
+
+  Mode mode;
+  // geometric: p is rounded up to the next value ceil((1+epsilon)^k)
+  double epsilon;
+  // grid: p is rounded up to the next multiple of grid_step
+  Time grid_step;
+};
+
+// opt-in approximation: required machines are rounded up to few size classes,
+// so the keys of the job pool collapse (and identical jobs can be grouped)
+// a requirement is never rounded beyond the bound of its class in the tower schedule (m/4, m/3, m/2, m),
+// so the tiny/small/medium/big partition is kept
+struct Machine_Rounding {
+  enum Mode { none, geometric, grid };
+
+  Mode mode;
+  // geometric: q is rounded up to the next value ceil((1+epsilon)^k)
+  double epsilon;
+  // grid: q is rounded up to the next multiple of m/classes
+  uint classes;
+};
+
+Time round_processing_time(Time processing_time, const Processing_Time_Rounding& rounding);
+
+Job_List round_processing_times(Job_List jobs, const Processing_Time_Rounding& rounding);
+
+Machines round_required_machines(Machines required_machines, Machines m, const Machine_Rounding& rounding);
+
+Job_List round_required_machines(Job_List jobs, Machines m, const Machine_Rounding& rounding);
+
+// max(area/m, p_max) of the jobs
+double get_makespan_lower_bound(const Job_List& jobs, Machines m);
+
+// what the rounding cost
+struct Rounding_Report {
+  // makespan of the schedule with the original processing times
+  Time makespan;
+  // makespan of the schedule with the rounded processing times
+  Time rounded_makespan;
+  // lower bound of the unrounded jobs
+  double lower_bound;
+  // makespan / lower_bound
+  double ratio;
+  size_t distinct_processing_times;
+  size_t distinct_rounded_processing_times;
+  size_t distinct_required_machines;
+  size_t distinct_rounded_required_machines;
+  // share of the area reserved for the rounded jobs which the original jobs do not use
+  double lost_utilization;
+};
@@ -1,19 +1,24 @@
 #include "schedule.hpp"
+#include "compaction.hpp"
 
-Schedule::Schedule(uint m, uint n) 
+#include <numeric>
+
+template<Gap_Structure GM>
+Basic_Schedule<GM>::Basic_Schedule(Machines m, uint n) 
   : m(m), n(n)
 {
   if(m<2)
     throw runtime_error("need to have at least 2 machines");
 
-  gap_manager = make_shared<Gap_Manager>(m);
+  gap_manager = make_shared<GM>(m);
 
   /* jobs.capacity(n); */
   // sort jobs
   // ...
 }
 
-void Schedule::schedule_job(Job& job, uint time) {
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::schedule_job(Job& job, Time time) {
   if(time == INVALID_TIME)
     time = gap_manager->update_earliest_time_to_place(job);
 
@@ -24,125 +29,253 @@ void Schedule::schedule_job(Job& job, uint time) {
 }
 
 // Expects sorted (by starting_time) list of indices
-// returns unscheduled jobs
-Job_List Schedule::unschedule_jobs(vector<uint> placed_jobs_indices) {
-  sort(placed_jobs_indices.begin(), placed_jobs_indices.end()); // redundant
-
-  Job_List new_jobs;
+// returns unscheduled jobs, the order of the remaining jobs is kept
+// the makespan is lowered to the end of the remaining jobs
+template<Gap_Structure GM>
+Job_List Basic_Schedule<GM>::unschedule_jobs(vector<uint> placed_jobs_indices) {
   Job_List removed_jobs;
+  removed_jobs.reserve(placed_jobs_indices.size());
+  for(uint i : placed_jobs_indices)
+    removed_jobs.push_back(placed_jobs[i]);
+
+  gap_manager->remove_jobs(removed_jobs);
+
+  // removed jobs are marked by their missing starting time and dropped in one pass
+  for(uint i : placed_jobs_indices)
+    placed_jobs[i].starting_time.reset();
+  erase_if(placed_jobs, [](const Job& job) { return !job.starting_time.has_value(); });
+
+  for(Job& job : removed_jobs)
+    job.starting_time.reset();
+  return removed_jobs;
+}
 
-  int current_index = 0;
-  for(int i = 0; i < placed_jobs.size(); i++) {
-    Job job = placed_jobs[i];
-
-    if(current_index < placed_jobs_indices.size() && i == placed_jobs_indices[current_index]) {
-      uint time = job.starting_time.value();
-      gap_manager->add_additional_machines_at(time,                    +job.required_machines); 
-      gap_manager->add_additional_machines_at(time+job.processing_time,-job.required_machines);
-      current_index += 1;
-      job.starting_time.reset();
-      removed_jobs.push_back(job);
+// the jobs are moved in order of their starting times, so each one can take the machines freed by the ones before
+// the cursor at the starting time of the cancelled job is computed once, only jobs starting there change it
+// only the cancelled job is erased from placed_jobs, a moved job is rotated in front of the jobs starting after it
+// (it only moves down, so it stays in front of the jobs after the moved ones)
+template<Gap_Structure GM>
+Time Basic_Schedule<GM>::cancel_job(uint job_index, uint max_moves) {
+  Job cancelled_job = placed_jobs.at(job_index);
+  Time cancelled_time = cancelled_job.starting_time.value();
+  gap_manager->remove_job_at(cancelled_job, cancelled_time);
+  placed_jobs.erase(placed_jobs.begin() + job_index);
+
+  // ids which do not belong to placed_jobs any more are dropped (see assign_job_ids)
+  if(placed_job_ids.size() != placed_jobs.size() + 1)
+    clear_job_ids();
+  bool has_ids = !placed_job_ids.empty();
+  if(has_ids) {
+    jobs_by_id[placed_job_ids[job_index]].starting_time.reset();
+    placed_job_ids.erase(placed_job_ids.begin() + job_index);
+  }
+
+  // the jobs in front of the cancelled job which start at the same time can not move down
+  size_t first_later_job = partition_point(placed_jobs.begin(), placed_jobs.begin() + job_index, [cancelled_time](const Job& job) {
+    return job.starting_time.value() < cancelled_time;
+  }) - placed_jobs.begin();
+  size_t last_moved_job = job_index + min<size_t>(max_moves, placed_jobs.size() - job_index);
+
+  Gap_Cursor cancelled_cursor = gap_manager->get_cursor_at(cancelled_time);
+  for(size_t i = job_index; i < last_moved_job; i++) {
+    Job& job = placed_jobs[i];
+    Time old_time = job.starting_time.value();
+    gap_manager->remove_job_at(job, old_time);
+    if(old_time == cancelled_time)
+      cancelled_cursor.available_machines += job.required_machines;
+
+    // the job fits at its old starting time at the latest
+    Gap_Cursor cursor = cancelled_cursor;
+    Time time = gap_manager->find_earliest_time_to_fit(job, cursor);
+    gap_manager->place_job_at(job, time);
+    if(time == cancelled_time)
+      cancelled_cursor.available_machines -= job.required_machines;
+    job.starting_time = time;
+    if(has_ids)
+      jobs_by_id[placed_job_ids[i]].starting_time = time;
+
+    // the new position is after the jobs which start before the job (or with a smaller id at the same time)
+    size_t low = first_later_job, high = i;
+    while(low < high) {
+      size_t middle = (low + high) / 2;
+      if(starts_before(job, placed_jobs[middle])
+         || (!starts_before(placed_jobs[middle], job) && has_ids && placed_job_ids[i] < placed_job_ids[middle]))
+        high = middle;
+      else
+        low = middle + 1;
     }
-    else 
-      new_jobs.push_back(job);
+    rotate(placed_jobs.begin() + low, placed_jobs.begin() + i, placed_jobs.begin() + i + 1);
+    if(has_ids)
+      rotate(placed_job_ids.begin() + low, placed_job_ids.begin() + i, placed_job_ids.begin() + i + 1);
   }
-  placed_jobs = new_jobs;
-  return removed_jobs;
+
+  return get_makespan();
+}
+
+template<Gap_Structure GM>
+Time Basic_Schedule<GM>::cancel_job_by_id(uint id, uint max_moves) {
+  return cancel_job(get_job_position(id), max_moves);
+}
+
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::assign_job_ids() {
+  stable_sort(placed_jobs.begin(), placed_jobs.end(), starts_before);
+  placed_job_ids.resize(placed_jobs.size());
+  iota(placed_job_ids.begin(), placed_job_ids.end(), 0);
+  jobs_by_id = placed_jobs;
+}
+
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::clear_job_ids() {
+  placed_job_ids.clear();
+  jobs_by_id.clear();
+}
+
+// placed_jobs is ordered by starts_before and the ids (see cancel_job), so the job is found by a binary search
+template<Gap_Structure GM>
+uint Basic_Schedule<GM>::get_job_position(uint id) const {
+  if(placed_job_ids.size() != placed_jobs.size())
+    throw logic_error("the job ids are out of date");
+  const Job& job = jobs_by_id.at(id);
+  if(!job.starting_time.has_value())
+    throw out_of_range("the job " + to_string(id) + " was cancelled");
+
+  size_t low = 0, high = placed_jobs.size();
+  while(low < high) {
+    size_t middle = (low + high) / 2;
+    if(starts_before(placed_jobs[middle], job)
+       || (!starts_before(job, placed_jobs[middle]) && placed_job_ids[middle] < id))
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  return low;
 }
 
 // list schedules jobs without letting the differences of jobs placed be more than p_max
 // makespan - balance_time is the initial upper_bound to not place jobs above
-void Schedule::balanced_list_schedule(Job_List jobs, Schedule& sigma1, Schedule& sigma2, sint& balance_time) {
-  uint sigma1_old_makespan = sigma1.get_makespan();
-  uint sigma2_old_makespan = sigma2.get_makespan();
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::balanced_list_schedule(const Job_List& jobs, Basic_Schedule& sigma1, Basic_Schedule& sigma2, Time_Difference& balance_time) {
+  balanced_list_schedule(to_job_groups(jobs), sigma1, sigma2, balance_time);
+}
+
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::balanced_list_schedule(Job_Group_List groups, Basic_Schedule& sigma1, Basic_Schedule& sigma2, Time_Difference& balance_time) {
+  Time sigma1_old_makespan = sigma1.get_makespan();
+  Time sigma2_old_makespan = sigma2.get_makespan();
+  size_t sigma1_first_new_job = sigma1.placed_jobs.size();
+  size_t sigma2_first_new_job = sigma2.placed_jobs.size();
   sigma1.gap_manager->reset_structure();
   sigma2.gap_manager->reset_structure();
 
-  multiset<pair<uint, size_t>> job_pool = create_job_pool(jobs);
+  multiset<pair<Machines, size_t>> job_pool = create_job_pool(groups);
 
   while(!job_pool.empty()) {
-    uint gap_end1 = max(static_cast<sint>(sigma1_old_makespan - balance_time), 0);
-    uint gap_end2 = max(static_cast<sint>(sigma2_old_makespan - balance_time), 0);
+    // makespan - balance_time (clamped at 0) in the signed difference type, so neither side wraps around
+    Time gap_end1 = static_cast<Time>(max<Time_Difference>(static_cast<Time_Difference>(sigma1_old_makespan) - balance_time, 0));
+    Time gap_end2 = static_cast<Time>(max<Time_Difference>(static_cast<Time_Difference>(sigma2_old_makespan) - balance_time, 0));
 
-    sigma1.list_schedule_single(/*jobs=*/jobs, /*job_pool=*/job_pool, /*until_t=*/gap_end1);
+    bool sigma1_stopped = sigma1.list_schedule_single(/*groups=*/groups, /*job_pool=*/job_pool, /*until_t=*/gap_end1);
     if(job_pool.empty())
       break;
 
-    sigma2.list_schedule_single(/*jobs=*/jobs, /*job_pool=*/job_pool, /*until_t=*/gap_end2);
+    bool sigma2_stopped = sigma2.list_schedule_single(/*groups=*/groups, /*job_pool=*/job_pool, /*until_t=*/gap_end2);
     if(job_pool.empty())
       break;
 
     // get larger gap
     auto min_job_iterator = job_pool.begin(); 
     uint min_job_index = min_job_iterator->second;
-    Job min_job = jobs[min_job_index];
+    Job min_job = groups[min_job_index].job;
 
-    uint earliest_time_to_place_a_job1 = sigma1.gap_manager->update_earliest_time_to_place(min_job);
-    uint earliest_time_to_place_a_job2 = sigma2.gap_manager->update_earliest_time_to_place(min_job);
-    uint g1 = max(0, static_cast<sint>(gap_end1-earliest_time_to_place_a_job1));
-    uint g2 = max(0, static_cast<sint>(gap_end2-earliest_time_to_place_a_job2));
+    Time earliest_time_to_place_a_job1 = sigma1.gap_manager->update_earliest_time_to_place(min_job);
+    Time earliest_time_to_place_a_job2 = sigma2.gap_manager->update_earliest_time_to_place(min_job);
+    Time g1 = gap_end1 > earliest_time_to_place_a_job1 ? gap_end1 - earliest_time_to_place_a_job1 : 0;
+    Time g2 = gap_end2 > earliest_time_to_place_a_job2 ? gap_end2 - earliest_time_to_place_a_job2 : 0;
 
 
     // update balance_time so that we have afterwards p_max time available in the larger gap 
     // where the actual gap is the time between g1 and balance_time
     if(g1 < min_job.processing_time && g2 < min_job.processing_time) 
       balance_time -= min_job.processing_time - max(g1,g2);
+    else if(sigma1_stopped && sigma2_stopped) {
+      // the widest job which fits is longer than both gaps (but the narrowest is not),
+      // without more time the next round would be the same one
+      Time p_max = 0;
+      for(const auto& [required_machines, index] : job_pool)
+        p_max = max(p_max, groups[index].job.processing_time);
+      if(g1 < p_max && g2 < p_max)
+        balance_time -= p_max - max(g1,g2);
+    }
   }
-  sort_jobs_increasingly_by_starting_time(sigma1.placed_jobs);
-  sort_jobs_increasingly_by_starting_time(sigma2.placed_jobs);
+  sigma1.merge_placed_jobs(sigma1_first_new_job);
+  sigma2.merge_placed_jobs(sigma2_first_new_job);
 }
 
-multiset<pair<uint, size_t>> Schedule::create_job_pool(Job_List jobs) {
-  multiset<pair<uint, size_t>> job_pool;
+// the pool holds the indices of the groups which have copies left (ordered by required machines)
+template<Gap_Structure GM>
+multiset<pair<Machines, size_t>> Basic_Schedule<GM>::create_job_pool(const Job_Group_List& groups) {
+  multiset<pair<Machines, size_t>> job_pool;
 
-  for(size_t i = 0; i < jobs.size(); i++) 
-    job_pool.insert({jobs[i].required_machines, i});
+  for(size_t i = 0; i < groups.size(); i++) 
+    if(groups[i].count != 0)
+      job_pool.insert({groups[i].job.required_machines, i});
 
   return job_pool;
 }
 
-bool Schedule::list_schedule(Job_List& jobs, uint until_t) {
-  multiset<pair<uint, size_t>> job_pool = create_job_pool(jobs);
+template<Gap_Structure GM>
+bool Basic_Schedule<GM>::list_schedule(Job_List& jobs, Time until_t) {
+  Job_Group_List groups = to_job_groups(jobs);
+  bool stop = list_schedule(groups, until_t);
+  jobs = expand_job_groups(groups);
+  return stop;
+}
+
+// all copies of a group which fit next to each other are placed in one step
+// groups is left with the copies which were not scheduled
+template<Gap_Structure GM>
+bool Basic_Schedule<GM>::list_schedule(Job_Group_List& groups, Time until_t) {
+  size_t first_new_job = placed_jobs.size();
+  multiset<pair<Machines, size_t>> job_pool = create_job_pool(groups);
 
   bool stop = false;
   while(!job_pool.empty() && !stop)
-    stop = list_schedule_single(/*jobs=*/jobs, /*job_pool=*/job_pool,until_t);
+    stop = list_schedule_single(/*groups=*/groups, /*job_pool=*/job_pool,until_t);
 
-  jobs = update_remaining_jobs_with_job_pool(jobs, job_pool);
+  groups = update_remaining_jobs_with_job_pool(groups, job_pool);
   
-  sort_jobs_increasingly_by_starting_time(placed_jobs);
+  merge_placed_jobs(first_new_job);
 
   return stop;
 }
 
-Job_List Schedule::update_remaining_jobs_with_job_pool(Job_List jobs, multiset<pair<uint, size_t>> &job_pool) {
-  Job_List new_jobs;
+template<Gap_Structure GM>
+Job_Group_List Basic_Schedule<GM>::update_remaining_jobs_with_job_pool(const Job_Group_List& groups, multiset<pair<Machines, size_t>> &job_pool) {
+  Job_Group_List new_groups;
   while(!job_pool.empty()){ 
     auto next_job_iterator = job_pool.begin(); 
     uint next_job_index = next_job_iterator->second;
-    Job next_job = jobs[next_job_index];
-    new_jobs.push_back(next_job);
+    new_groups.push_back(groups[next_job_index]);
     job_pool.erase(next_job_iterator);
   }
-  return new_jobs;
+  return new_groups;
 }
 
 // jobs need to have machine requirement at most m/2
-void Schedule::on_two_stacks(Job_List jobs) {
+// both stacks start at the makespan
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::on_two_stacks(Job_List jobs) {
   sort_jobs_decreasingly_by_required_machines(jobs);
 
-  Job dummy_job(1, 1);    // required_machines = 1
-  Gap_Manager dummy_gap_manager = *gap_manager;
-  for(Job& job : jobs) {
-    uint time = dummy_gap_manager.update_earliest_time_to_place(dummy_job);
+  Two_Stacks stacks(get_makespan());
+  for(Job& job : jobs) 
+    job.starting_time = stacks.place(job.processing_time);
 
-    if(dummy_gap_manager.available_machines_in_gap == m-1)
-      dummy_gap_manager.place_job_at(Job(job.processing_time, m-1), time);
-    else  // == 1
-      dummy_gap_manager.place_job_at(Job(job.processing_time, 1), time);
-    
-    schedule_job(job, time);
-  }
+  size_t first_new_job = placed_jobs.size();
+  gap_manager->place_jobs(jobs);
+  placed_jobs.insert(placed_jobs.end(), jobs.begin(), jobs.end());
+  merge_placed_jobs(first_new_job);
 }
 
 
@@ -150,19 +283,40 @@ void Schedule::on_two_stacks(Job_List jobs) {
 // returns a list of jobs which were not schedule during this step
 // starts at the top and places repeatedly the widest job which fits directly below the last one
 // assumes the existing jobs are decreasingly placed in machine_requirement
-Job_List Schedule::schedule_down(Job_List jobs) {
+template<Gap_Structure GM>
+Job_List Basic_Schedule<GM>::schedule_down(Job_List jobs) {
   sort_jobs_decreasingly_by_required_machines(jobs);
 
-  map<uint,uint> inverse_absolute_gaps = gap_manager->build_inverse_absolute_gaps();
-  uint makespan = gap_manager->get_makespan();
+  Absolute_Gap_List inverse_absolute_gaps = gap_manager->build_inverse_absolute_gaps();
+  Time makespan = gap_manager->get_makespan();
   
-  uint used_time = 0;
+  Time used_time = 0;
   Job_List jobs_to_schedule;
   Job_List jobs_unused;
 
+  // used_time only increases, so the first entry which ends at or after used_time does too.
+  // the entry at the end of a job is searched from there on
+  size_t used_time_index = 0;
+  auto ends_before = [](const Absolute_Gap& gap, Time time) { return gap.time < time; };
+
   for(Job& job : jobs) {
-    uint available_machines_during_job_end = 
-      inverse_absolute_gaps.lower_bound(used_time + job.processing_time)->second;
+    while(used_time_index < inverse_absolute_gaps.size() && inverse_absolute_gaps[used_time_index].time < used_time)
+      used_time_index++;
+
+    // gallop to the entry at the end of the job
+    Time job_end = used_time + job.processing_time;
+    size_t step = 1;
+    size_t lower = used_time_index;
+    while(lower + step < inverse_absolute_gaps.size() && inverse_absolute_gaps[lower + step].time < job_end) {
+      lower += step;
+      step *= 2;
+    }
+    size_t upper = min(lower + step + 1, inverse_absolute_gaps.size());
+    auto job_end_gap = lower_bound(inverse_absolute_gaps.begin() + lower, inverse_absolute_gaps.begin() + upper, job_end, ends_before);
+
+    // no machines are available below time 0
+    Machines available_machines_during_job_end = 
+      job_end_gap == inverse_absolute_gaps.end() ? 0 : job_end_gap->available_machines;
     
     if(available_machines_during_job_end >= job.required_machines) {
       used_time += job.processing_time;
@@ -173,18 +327,20 @@ Job_List Schedule::schedule_down(Job_List jobs) {
       jobs_unused.push_back(job);
   }
 
-  // schedule jobs
-  for(int i = jobs_to_schedule.size()-1; i >= 0; i--) {
-    Job job = jobs_to_schedule[i];
-    schedule_job(job, job.starting_time.value());
-  }
+  // schedule jobs (the jobs are stacked, so adjacent jobs share their updates)
+  reverse(jobs_to_schedule.begin(), jobs_to_schedule.end());
+  size_t first_new_job = placed_jobs.size();
+  gap_manager->place_jobs(jobs_to_schedule);
+  placed_jobs.insert(placed_jobs.end(), jobs_to_schedule.begin(), jobs_to_schedule.end());
+  merge_placed_jobs(first_new_job);
 
   return jobs_unused;
 }
 
 // jobs which start at or below separation_time will be scheduled in s1
 // the remaining jobs will be scheduled in s2
-void Schedule::split_at(uint separation_time, Schedule& lower_schedule, Schedule& upper_schedule) {
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::split_at(Time separation_time, Basic_Schedule& lower_schedule, Basic_Schedule& upper_schedule) {
   for(auto& job : placed_jobs) {
     if(job.starting_time.value() < separation_time)
       lower_schedule.schedule_job(job, job.starting_time.value());
@@ -193,16 +349,19 @@ void Schedule::split_at(uint separation_time, Schedule& lower_schedule, Schedule
   }
 }
 
-uint Schedule::get_makespan() {
+template<Gap_Structure GM>
+Time Basic_Schedule<GM>::get_makespan() const {
   return gap_manager->get_makespan();
 }
 
-void Schedule::set_makespan(uint new_makespan) {
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::set_makespan(Time new_makespan) {
   gap_manager->makespan = new_makespan;
 }
 
 // assumes that the current schedule is valid for this operation
-void Schedule::sort_in_higher_stack(Job_List jobs) {
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::sort_in_higher_stack(Job_List jobs) {
   Job_List jobs_on_higher_stack = jobs;
   Job_List jobs_on_lower_stack;
 
@@ -211,8 +370,7 @@ void Schedule::sort_in_higher_stack(Job_List jobs) {
   } 
   else {
     // the last placed job is on the higher stack 
-    Job last_job = placed_jobs[placed_jobs.size()-1];
-    uint current_time = get_makespan();
+    Time current_time = get_makespan();
     
     for(int i=placed_jobs.size()-1; i>=0; i--) {
       Job job = placed_jobs[i];
@@ -230,59 +388,171 @@ void Schedule::sort_in_higher_stack(Job_List jobs) {
   sort_jobs_decreasingly_by_required_machines(jobs_on_lower_stack);
 
   // create new gap manager and iterate through jobs in stacks and place them
-  gap_manager = make_shared<Gap_Manager>(m);
+  gap_manager = make_shared<GM>(m);
   placed_jobs = {};
   
+  // both stacks are sorted by themselves
   schedule_jobs_on_top_of_each_other(jobs_on_higher_stack);
+  merge_placed_jobs(0);
+  size_t first_lower_stack_job = placed_jobs.size();
   schedule_jobs_on_top_of_each_other(jobs_on_lower_stack);
-
-  sort_jobs_increasingly_by_starting_time(placed_jobs);
+  merge_placed_jobs(first_lower_stack_job);
 }
 
-void Schedule::schedule_jobs_on_top_of_each_other(Job_List jobs, uint start_time) {
-  for(auto job : jobs) {
-    schedule_job(job, start_time);
+// adjacent jobs share their updates of the gaps
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::schedule_jobs_on_top_of_each_other(Job_List jobs, Time start_time) {
+  for(Job& job : jobs) {
+    job.starting_time = start_time;
     start_time += job.processing_time;
   }
+
+  gap_manager->place_jobs(jobs);
+  placed_jobs.insert(placed_jobs.end(), jobs.begin(), jobs.end());
+}
+
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::schedule_jobs_on_top_of_each_other(const Job_Group_List& groups, Time start_time) {
+  schedule_jobs_on_top_of_each_other(expand_job_groups(groups), start_time);
 }
 
 // returns the removed jobs
-Job_List Schedule::remove_jobs_above(uint time) {
+template<Gap_Structure GM>
+Job_List Basic_Schedule<GM>::remove_jobs_above(Time time) {
   return remove_jobs_if([time](const Job& job) {
     return job.starting_time.value() + job.processing_time > time;
   });
 }
 
-void Schedule::place_schedule_on_top(Schedule& schedule) {
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::place_schedule_on_top(Basic_Schedule& schedule) {
+  list_schedule_on_top(schedule.placed_jobs);
+
+  schedule = Basic_Schedule(schedule.m, schedule.n);
+}
+
+// the jobs of the view are list scheduled one by one like above (only building the rotated gaps is saved)
+// the rotated schedule itself is not changed
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::place_schedule_on_top(const Rotated_Schedule_View& schedule) {
+  Job_List jobs = schedule.get_jobs();
+  list_schedule_on_top(jobs);
+}
+
+// places schedule unchanged at the current makespan (without list scheduling its jobs)
+// the gap structure of schedule is spliced into this one, schedule is cleared afterwards
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::stack_schedule_on_top(Basic_Schedule& schedule) {
+  Time offset = get_makespan();
+
   sort_jobs_increasingly_by_starting_time_and_second_by_required_machines(schedule.placed_jobs);
-  for(auto job : schedule.placed_jobs) 
-    schedule_job(job);
+  placed_jobs.reserve(placed_jobs.size() + schedule.placed_jobs.size());
+  for(auto job : schedule.placed_jobs) {
+    job.starting_time = job.starting_time.value() + offset;
+    placed_jobs.push_back(job);
+  }
 
-  schedule = Schedule(schedule.m, schedule.n);
+  gap_manager->stack_on_top(*schedule.gap_manager);
+  if(!schedule.placed_jobs.empty())
+    move_cursor_to_last_job();
+
+  schedule = Basic_Schedule(schedule.m, schedule.n);
 }
 
-Schedule Schedule::get_rotated_schedule() {
-  Schedule rotated_schedule(m,n);
-  uint makespan = get_makespan();
-  for(auto job : placed_jobs | views::reverse)
-    rotated_schedule.schedule_job(job,/*time=*/makespan-job.starting_time.value()-job.processing_time);
+// the rotated schedule itself is not changed
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::stack_schedule_on_top(const Rotated_Schedule_View& schedule) {
+  Time offset = get_makespan();
 
-  sort_jobs_increasingly_by_starting_time(rotated_schedule.placed_jobs);
+  Job_List jobs = schedule.get_jobs();
+  sort_jobs_increasingly_by_starting_time_and_second_by_required_machines(jobs);
+  placed_jobs.reserve(placed_jobs.size() + jobs.size());
+  for(auto job : jobs) {
+    job.starting_time = job.starting_time.value() + offset;
+    placed_jobs.push_back(job);
+  }
 
-  return rotated_schedule;
+  gap_manager->stack_gaps_on_top(schedule.get_gaps(), schedule.get_makespan());
+  if(!jobs.empty())
+    move_cursor_to_last_job();
+}
+
+// constant time, the schedule must not be changed while the view is used
+template<Gap_Structure GM>
+Basic_Rotated_Schedule_View<GM> Basic_Schedule<GM>::get_rotated_view() const {
+  return Rotated_Schedule_View(*this);
+}
+
+template<Gap_Structure GM>
+Basic_Schedule<GM> Basic_Schedule<GM>::get_rotated_schedule() const {
+  return get_rotated_view().materialize();
+}
+
+template<Gap_Structure GM>
+Basic_Schedule<GM> Basic_Schedule<GM>::get_copy() const {
+  Basic_Schedule copy = *this;
+  copy.gap_manager = make_shared<GM>(*gap_manager);
+  return copy;
+}
+
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::rebuild_gaps() {
+  gap_manager = make_shared<GM>(m);
+  gap_manager->place_jobs(placed_jobs);
+  move_cursor_to_last_job();
+}
+
+template<Gap_Structure GM>
+Time Basic_Schedule<GM>::compact() {
+  placed_jobs = compact_jobs(move(placed_jobs), m);
+  rebuild_gaps();
+  return get_makespan();
+}
+
+// the last placed job starts last (after stacking, the stacked jobs are sorted and start above all others)
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::move_cursor_to_last_job() {
+  if(placed_jobs.empty())
+    return;
+
+  Gap_Cursor cursor = gap_manager->get_cursor_at(placed_jobs.back().starting_time.value());
+  gap_manager->current_time = cursor.time;
+  gap_manager->available_machines_in_gap = cursor.available_machines;
+}
+
+// list schedules the jobs in order of their starting times
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::list_schedule_on_top(Job_List& jobs) {
+  sort_jobs_increasingly_by_starting_time_and_second_by_required_machines(jobs);
+  for(auto job : jobs) 
+    schedule_job(job);
+}
+
+// the placed jobs before first_unsorted_job need to be sorted by starting time already,
+// the jobs from there on (which were placed in one step) are sorted and merged into them
+template<Gap_Structure GM>
+void Basic_Schedule<GM>::merge_placed_jobs(size_t first_unsorted_job) {
+  auto first_unsorted = placed_jobs.begin() + first_unsorted_job;
+
+  // list scheduling places the jobs in this order already
+  if(!is_sorted(first_unsorted, placed_jobs.end(), starts_before))
+    sort(first_unsorted, placed_jobs.end(), starts_before);
+
+  inplace_merge(placed_jobs.begin(), first_unsorted, placed_jobs.end(), starts_before);
 }
 
 // until_t ensures that no job will be executed after until_t
 // assumes job_pool.empty()==false
 // returns if procedure should end
-bool Schedule::list_schedule_single(Job_List jobs, multiset<pair<uint, size_t>> &job_pool, uint until_t) {
+template<Gap_Structure GM>
+bool Basic_Schedule<GM>::list_schedule_single(Job_Group_List& groups, multiset<pair<Machines, size_t>> &job_pool, Time until_t) {
     auto min_job_iterator = job_pool.begin(); 
-    // index i with jobs[i] has lowest required machines 
+    // index i with groups[i] has lowest required machines 
     uint min_job_index = min_job_iterator->second;
-    Job min_job = jobs[min_job_index];
+    Job min_job = groups[min_job_index].job;
 
-    uint time = gap_manager->update_earliest_time_to_place(min_job);
-    uint available_machines = gap_manager->available_machines_in_gap;
+    Time time = gap_manager->update_earliest_time_to_place(min_job);
+    Machines available_machines = gap_manager->available_machines_in_gap;
 
     // find index i where jobs[i].required_machines is the smallest value ..
     // such that jobs[i].required_machines > available_machines
@@ -295,13 +565,105 @@ bool Schedule::list_schedule_single(Job_List jobs, multiset<pair<uint, size_t>>
     // take the previous key
     // large_jobs_iterator must be larger than job_pool.begin() at this time
     --large_job_iterator; 
+
+    // jobs placed before can start above the cursor (schedule_down places from the top),
+    // so a job is only taken if it has enough machines during its whole processing time
+    Gap_Cursor cursor = {time, available_machines};
+    auto get_available_machines_during = [&](const Job& job) {
+      return gap_manager->get_minimum_available_machines(cursor, checked_add(time, job.processing_time));
+    };
+    Machines available_machines_during_job = get_available_machines_during(groups[large_job_iterator->second].job);
+    while(available_machines_during_job < groups[large_job_iterator->second].job.required_machines) {
+      if(large_job_iterator == job_pool.begin()) {
+        // no job fits here, the cursor goes on to the earliest time where the narrowest one fits
+        gap_manager->find_earliest_time_to_fit(min_job, cursor);
+        gap_manager->current_time = cursor.time;
+        gap_manager->available_machines_in_gap = cursor.available_machines;
+        return false;
+      }
+      --large_job_iterator;
+      available_machines_during_job = get_available_machines_during(groups[large_job_iterator->second].job);
+    }
+
     uint large_job_index = large_job_iterator->second;
-    Job large_job = jobs[large_job_index];
+    Job_Group& large_group = groups[large_job_index];
+    Job large_job = large_group.job;
     
     if(until_t != INVALID_TIME && until_t < time+large_job.processing_time)
       return true;
 
-    schedule_job(large_job, time);
-    job_pool.erase(large_job_iterator);
+    // placing the copies one by one would select this group again until they do not fit anymore,
+    // so all of them are placed at once (as one wide job in the gaps)
+    uint copies = large_group.count;
+    if(large_job.required_machines != 0)
+      copies = static_cast<uint>(min<unsigned long long>(copies, available_machines_during_job / large_job.required_machines));
+
+    gap_manager->place_job_at(Job(large_job.processing_time, copies * large_job.required_machines), time);
+    large_job.starting_time = time;
+    placed_jobs.insert(placed_jobs.end(), copies, large_job);
+
+    large_group.count -= copies;
+    if(large_group.count == 0)
+      job_pool.erase(large_job_iterator);
     return false;
 }
+
+
+template<Gap_Structure GM>
+Basic_Rotated_Schedule_View<GM>::Basic_Rotated_Schedule_View(const Basic_Schedule<GM>& schedule)
+  : schedule(schedule), makespan(schedule.get_makespan())
+{}
+
+template<Gap_Structure GM>
+Time Basic_Rotated_Schedule_View<GM>::get_makespan() const {
+  return makespan;
+}
+
+template<Gap_Structure GM>
+size_t Basic_Rotated_Schedule_View<GM>::size() const {
+  return schedule.placed_jobs.size();
+}
+
+// i-th job of the viewed schedule with its rotated starting time
+template<Gap_Structure GM>
+Job Basic_Rotated_Schedule_View<GM>::get_job(size_t i) const {
+  Job job = schedule.placed_jobs[i];
+  job.starting_time = makespan - job.starting_time.value() - job.processing_time;
+  return job;
+}
+
+// jobs with rotated starting times (in reverse order of the viewed schedule)
+template<Gap_Structure GM>
+Job_List Basic_Rotated_Schedule_View<GM>::get_jobs() const {
+  Job_List jobs;
+  jobs.reserve(size());
+  for(size_t i = size(); i > 0; i--)
+    jobs.push_back(get_job(i-1));
+  return jobs;
+}
+
+template<Gap_Structure GM>
+vector<Gap> Basic_Rotated_Schedule_View<GM>::get_gaps() const {
+  return schedule.gap_manager->get_rotated_gaps();
+}
+
+template<Gap_Structure GM>
+Basic_Schedule<GM> Basic_Rotated_Schedule_View<GM>::materialize() const {
+  Basic_Schedule<GM> rotated_schedule(schedule.m, schedule.n);
+  rotated_schedule.gap_manager->stack_gaps_on_top(get_gaps(), makespan);
+  rotated_schedule.placed_jobs = get_jobs();
+  sort_jobs_increasingly_by_starting_time(rotated_schedule.placed_jobs);
+  return rotated_schedule;
+}
+
+template class Basic_Schedule<Gap_Manager>;
+template class Basic_Schedule<Map_Gap_Manager>;
+template class Basic_Schedule<Flat_Gap_Manager>;
+template class Basic_Schedule<Dense_Gap_Manager>;
+template class Basic_Schedule<Summed_Gap_Manager>;
+
+template class Basic_Rotated_Schedule_View<Gap_Manager>;
+template class Basic_Rotated_Schedule_View<Map_Gap_Manager>;
+template class Basic_Rotated_Schedule_View<Flat_Gap_Manager>;
+template class Basic_Rotated_Schedule_View<Dense_Gap_Manager>;
+template class Basic_Rotated_Schedule_View<Summed_Gap_Manager>;
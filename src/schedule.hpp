@@ -2,36 +2,95 @@
 
 #include "types.hpp"
 #include "gap_manager.hpp"
+#include "dense_gap_manager.hpp"
+
+template<Gap_Structure GM>
+class Basic_Rotated_Schedule_View;
+
+// two stacks of jobs which both start at the same time
+// a job is put on the stack which ends first (on the second one if both end at the same time)
+struct Two_Stacks {
+  Time first_stack_end;
+  Time second_stack_end;
+
+  Two_Stacks(Time start_time)
+    : first_stack_end(start_time), second_stack_end(start_time) {}
+
+  // returns the starting time of the job
+  Time place(Time processing_time) {
+    Time& stack_end = first_stack_end < second_stack_end ? first_stack_end : second_stack_end;
+    Time starting_time = stack_end;
+    stack_end += processing_time;
+    return starting_time;
+  }
+};
 
-class Schedule {
+// GM is the gap structure (see Gap_Structure), Schedule uses the pb_ds tree
+template<Gap_Structure GM>
+class Basic_Schedule {
 public:
-  uint m;
+  typedef Basic_Rotated_Schedule_View<GM> Rotated_Schedule_View;
+
+  Machines m;
   uint n;
   Job_List placed_jobs;
-  shared_ptr<Gap_Manager> gap_manager;
+  shared_ptr<GM> gap_manager;
+
+  // id of placed_jobs[i] (see assign_job_ids), empty without ids
+  vector<uint> placed_job_ids;
+  // the job of every id with its current starting time (none once it is cancelled)
+  Job_List jobs_by_id;
 
   /* Gap_List gap_list; */
 
-  Schedule(uint m, uint n);
+  Basic_Schedule(Machines m, uint n);
 
-  void schedule_job(Job& job, uint time = INVALID_TIME);
+  void schedule_job(Job& job, Time time = INVALID_TIME);
 
   // Expects sorted (by starting_time) list of indices
-  // returns unscheduled jobs
-  // does not affect the makespan. 
+  // returns unscheduled jobs, the order of the remaining jobs is kept
+  // the makespan is lowered to the end of the remaining jobs
   Job_List unschedule_jobs(vector<uint> placed_jobs_indices);
 
+  // removes placed_jobs[job_index] and repairs the schedule locally:
+  // the next max_moves jobs after the cancelled job in placed_jobs are moved down as far as they fit
+  // (the ones before it which start at the same time can not move), nothing below the cancelled job is touched,
+  // returns the new makespan
+  // besides erasing the job from placed_jobs the work only depends on max_moves and the gaps around the moved jobs
+  // (placed_jobs has to be sorted by starting time and stays sorted, so the moved jobs can get other indices)
+  Time cancel_job(uint job_index, uint max_moves = 64);
+
+  // cancel_job for the job with id
+  Time cancel_job_by_id(uint id, uint max_moves = 64);
+
+  // sorts placed_jobs by starting time and gives every placed job its index as id
+  // the ids stay valid through cancel_job, any other change of placed_jobs needs new ids
+  void assign_job_ids();
+
+  void clear_job_ids();
+
+  // current index of the job with id in placed_jobs, logarithmic
+  uint get_job_position(uint id) const;
+
   // list schedules jobs without letting the differences of jobs placed be more than p_max
   // makespan - balance_time is the initial upper_bound to not place jobs above
-  static void balanced_list_schedule(Job_List jobs, Schedule& sigma1, Schedule& sigma2, sint& balance_time);
+  static void balanced_list_schedule(const Job_List& jobs, Basic_Schedule& sigma1, Basic_Schedule& sigma2, Time_Difference& balance_time);
 
-  static multiset<pair<uint, size_t>> create_job_pool(Job_List jobs);
+  static void balanced_list_schedule(Job_Group_List groups, Basic_Schedule& sigma1, Basic_Schedule& sigma2, Time_Difference& balance_time);
 
-  bool list_schedule(Job_List& jobs, uint until_t=INVALID_TIME);
+  // the pool holds the indices of the groups which have copies left (ordered by required machines)
+  static multiset<pair<Machines, size_t>> create_job_pool(const Job_Group_List& groups);
 
-  Job_List update_remaining_jobs_with_job_pool(Job_List jobs, multiset<pair<uint, size_t>> &job_pool);
+  bool list_schedule(Job_List& jobs, Time until_t=INVALID_TIME);
+
+  // all copies of a group which fit next to each other are placed in one step
+  // groups is left with the copies which were not scheduled
+  bool list_schedule(Job_Group_List& groups, Time until_t=INVALID_TIME);
+
+  Job_Group_List update_remaining_jobs_with_job_pool(const Job_Group_List& groups, multiset<pair<Machines, size_t>> &job_pool);
 
   // jobs need to have machine requirement at most m/2
+  // both stacks start at the makespan
   void on_two_stacks(Job_List jobs);
 
   // returns a list of jobs which were not schedule during this step
@@ -41,16 +100,19 @@ public:
 
   // jobs which start at or below separation_time will be scheduled in s1
   // the remaining jobs will be scheduled in s2
-  void split_at(uint separation_time, Schedule& lower_schedule, Schedule& upper_schedule);
+  void split_at(Time separation_time, Basic_Schedule& lower_schedule, Basic_Schedule& upper_schedule);
 
-  uint get_makespan();
+  Time get_makespan() const;
 
-  void set_makespan(uint new_makespan);
+  void set_makespan(Time new_makespan);
 
   // assumes that the current schedule is valid for this operation
   void sort_in_higher_stack(Job_List jobs);
 
-  void schedule_jobs_on_top_of_each_other(Job_List jobs, uint start_time=0);
+  // adjacent jobs share their updates of the gaps
+  void schedule_jobs_on_top_of_each_other(Job_List jobs, Time start_time=0);
+
+  void schedule_jobs_on_top_of_each_other(const Job_Group_List& groups, Time start_time=0);
 
   template<typename Predicate>
   Job_List remove_jobs_if(Predicate should_remove) {
@@ -66,13 +128,38 @@ public:
   }
 
   // returns the removed jobs
-  Job_List remove_jobs_above(uint time);
+  Job_List remove_jobs_above(Time time);
+
+  void place_schedule_on_top(Basic_Schedule& schedule);
+
+  // the jobs of the view are list scheduled one by one like above (only building the rotated gaps is saved)
+  // the rotated schedule itself is not changed
+  void place_schedule_on_top(const Rotated_Schedule_View& schedule);
+
+  // places schedule unchanged at the current makespan (without list scheduling its jobs)
+  // the gap structure of schedule is spliced into this one, schedule is cleared afterwards
+  void stack_schedule_on_top(Basic_Schedule& schedule);
+
+  // the rotated schedule itself is not changed
+  void stack_schedule_on_top(const Rotated_Schedule_View& schedule);
+
+  // constant time, the schedule must not be changed while the view is used
+  Rotated_Schedule_View get_rotated_view() const;
 
-  void place_schedule_on_top(Schedule& schedule);
+  Basic_Schedule get_rotated_schedule() const;
 
-  Schedule get_rotated_schedule();
+  // a copy of a schedule shares the gap structure, this one copies it too
+  Basic_Schedule get_copy() const;
 
-  double calculate_makespan_lower_bound(uint p_max) const {
+  // builds the gaps again from placed_jobs (after their values were changed directly)
+  // the cursor is at the starting time of the last job
+  void rebuild_gaps();
+
+  // moves the jobs down into earlier gaps (see compact_jobs), the gaps are built again
+  // returns the new makespan
+  Time compact();
+
+  double calculate_makespan_lower_bound(Time p_max) const {
     if(p_max*n*m > numeric_limits<unsigned long long>::max())
       throw runtime_error("possible area overflow");
 
@@ -88,11 +175,52 @@ public:
 
 private:
 
+  // list schedules the jobs in order of their starting times
+  void list_schedule_on_top(Job_List& jobs);
+
+  // list scheduling only checks the available machines at the starting time of a job,
+  // so it must not start below a placed job (moves the cursor to the starting time of the last placed job)
+  void move_cursor_to_last_job();
+
+  // the placed jobs before first_unsorted_job need to be sorted by starting time already,
+  // the jobs from there on (which were placed in one step) are sorted and merged into them
+  void merge_placed_jobs(size_t first_unsorted_job);
+
   // until_t ensures that no job will be executed after until_t
   // assumes job_pool.empty()==false
   // returns if procedure should end
-  bool list_schedule_single(Job_List jobs, multiset<pair<uint, size_t>> &job_pool, uint until_t=INVALID_TIME);
+  bool list_schedule_single(Job_Group_List& groups, multiset<pair<Machines, size_t>> &job_pool, Time until_t=INVALID_TIME);
 
 
 };
 
+
+// schedule rotated by 180 degrees without copying it
+// a job running in [s, s+p) in the schedule runs in [makespan-s-p, makespan-s) in the view
+// the view can not be changed, to change the rotated schedule it needs to be materialized
+template<Gap_Structure GM>
+class Basic_Rotated_Schedule_View {
+public:
+  Basic_Rotated_Schedule_View(const Basic_Schedule<GM>& schedule);
+
+  Time get_makespan() const;
+
+  size_t size() const;
+
+  // i-th job of the viewed schedule with its rotated starting time
+  Job get_job(size_t i) const;
+
+  // jobs with rotated starting times (in reverse order of the viewed schedule)
+  Job_List get_jobs() const;
+
+  vector<Gap> get_gaps() const;
+
+  Basic_Schedule<GM> materialize() const;
+
+private:
+  const Basic_Schedule<GM>& schedule;
+  Time makespan;
+};
+
+typedef Basic_Schedule<Gap_Manager> Schedule;
+typedef Basic_Rotated_Schedule_View<Gap_Manager> Rotated_Schedule_View;
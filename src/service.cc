@@ -0,0 +1,260 @@
+#include "service.hpp"
+
+#include <numeric>
+#include <thread>
+#include <deque>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// returns the number of bytes read (less than size only at the end of the stream)
+static size_t read_exactly(int fd, void* buffer, size_t size) {
+  size_t bytes_read = 0;
+  while(bytes_read < size) {
+    ssize_t result = read(fd, static_cast<char*>(buffer) + bytes_read, size - bytes_read);
+    if(result < 0 && errno == EINTR)
+      continue;
+    if(result < 0)
+      throw runtime_error(string("read failed: ") + strerror(errno));
+    if(result == 0)
+      break;
+    bytes_read += result;
+  }
+  return bytes_read;
+}
+
+static void write_exactly(int fd, const void* buffer, size_t size) {
+  size_t bytes_written = 0;
+  while(bytes_written < size) {
+    ssize_t result = write(fd, static_cast<const char*>(buffer) + bytes_written, size - bytes_written);
+    if(result < 0 && errno == EINTR)
+      continue;
+    if(result < 0)
+      throw runtime_error(string("write failed: ") + strerror(errno));
+    bytes_written += result;
+  }
+}
+
+// the tower schedule does not keep the order of the jobs, identical jobs are interchangeable
+// so the placed jobs are matched to the request by processing time and required machines
+Service_Reply handle_request(const Service_Request& request, const Backend_Thresholds& thresholds) {
+  Service_Reply reply = {SERVICE_OK, 0, {}, ""};
+  try {
+    Job_List jobs = make_checked_jobs(request.raw_jobs, request.m);
+    if(jobs.empty())
+      return reply;
+
+    Tower_Result result = schedule_with_selected_backend(static_cast<Machines>(request.m), jobs, thresholds);
+
+    auto by_key = [](const Job& j1, const Job& j2) {
+      return make_pair(j1.processing_time, j1.required_machines) < make_pair(j2.processing_time, j2.required_machines);
+    };
+    vector<size_t> order(jobs.size());
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [&](size_t i, size_t j) { return by_key(jobs[i], jobs[j]); });
+    sort(result.placed_jobs.begin(), result.placed_jobs.end(), by_key);
+
+    reply.makespan = result.makespan;
+    reply.starting_times.resize(jobs.size());
+    for(size_t i = 0; i < order.size(); i++)
+      reply.starting_times[order[i]] = result.placed_jobs[i].starting_time.value();
+  }
+  catch(const exception& e) {
+    reply = Service_Reply{SERVICE_ERROR, 0, {}, e.what()};
+  }
+  return reply;
+}
+
+bool read_request(int fd, Service_Request& request) {
+  unsigned long long header[2];
+  size_t bytes_read = read_exactly(fd, header, sizeof(header));
+  if(bytes_read == 0)
+    return false;
+  if(bytes_read < sizeof(header))
+    throw runtime_error("stream ended within a request");
+
+  auto [m, n] = header;
+  if(n > SERVICE_MAX_JOBS)
+    throw length_error("request has more than " + to_string(SERVICE_MAX_JOBS) + " jobs");
+
+  request.m = m;
+  request.raw_jobs.clear();
+
+  // read in chunks, so the request is not copied as a whole
+  // (the buffer grows with the jobs which arrived, not with the n of the header)
+  unsigned long long values[2*1024];
+  while(request.raw_jobs.size() < n) {
+    size_t jobs_in_chunk = min<unsigned long long>(n - request.raw_jobs.size(), 1024);
+    if(read_exactly(fd, values, jobs_in_chunk * 2*sizeof(unsigned long long)) < jobs_in_chunk * 2*sizeof(unsigned long long))
+      throw runtime_error("stream ended within a request");
+    for(size_t i = 0; i < jobs_in_chunk; i++)
+      request.raw_jobs.push_back({values[2*i], values[2*i+1]});
+  }
+  return true;
+}
+
+void write_reply(int fd, const Service_Reply& reply) {
+  bool ok = reply.status == SERVICE_OK;
+  vector<unsigned long long> header = {reply.status, reply.makespan, ok ? reply.starting_times.size() : reply.error.size()};
+  write_exactly(fd, header.data(), header.size() * sizeof(unsigned long long));
+  if(ok)
+    write_exactly(fd, reply.starting_times.data(), reply.starting_times.size() * sizeof(unsigned long long));
+  else
+    write_exactly(fd, reply.error.data(), reply.error.size());
+}
+
+bool serve_request(int in_fd, int out_fd, Service_Request& request, const Backend_Thresholds& thresholds) {
+  try {
+    if(!read_request(in_fd, request))
+      return false;
+  }
+  catch(const length_error& e) {
+    // the rest of the request can not be skipped reliably
+    write_reply(out_fd, Service_Reply{SERVICE_ERROR, 0, {}, e.what()});
+    return false;
+  }
+  write_reply(out_fd, handle_request(request, thresholds));
+  return true;
+}
+
+void serve_stream(int in_fd, int out_fd, const Backend_Thresholds& thresholds) {
+  Service_Request request;
+  while(serve_request(in_fd, out_fd, request, thresholds)) {}
+}
+
+// the idle connections wait in poll, a connection with a request is handed to a worker for this request only
+// and goes back to poll afterwards, so idle clients do not keep the workers
+// (the connections are passed through two pipes, a write of one descriptor is atomic)
+void serve_unix_socket(const string& path, uint workers, const Backend_Thresholds& thresholds) {
+  // a client which disconnects early must not end the service
+  signal(SIGPIPE, SIG_IGN);
+
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if(path.size() >= sizeof(address.sun_path))
+    throw invalid_argument("socket path is too long");
+  strcpy(address.sun_path, path.c_str());
+
+  // only a socket left by an earlier service is replaced
+  struct stat status;
+  if(lstat(path.c_str(), &status) == 0) {
+    if(!S_ISSOCK(status.st_mode))
+      throw runtime_error(path + " exists and is not a socket");
+    unlink(path.c_str());
+  }
+
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(listen_fd < 0)
+    throw runtime_error(string("socket failed: ") + strerror(errno));
+  if(bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+     || listen(listen_fd, SOMAXCONN) < 0) {
+    string error = strerror(errno);
+    close(listen_fd);
+    throw runtime_error("listening on " + path + " failed: " + error);
+  }
+
+  // connections with a request go to the workers, answered ones come back
+  // (only the service side of each pipe is non-blocking)
+  int ready_fds[2], returned_fds[2];
+  if(pipe(ready_fds) < 0 || pipe(returned_fds) < 0) {
+    string error = strerror(errno);
+    close(listen_fd);
+    throw runtime_error("pipe failed: " + error);
+  }
+  fcntl(ready_fds[1], F_SETFL, O_NONBLOCK);
+  fcntl(returned_fds[0], F_SETFL, O_NONBLOCK);
+
+  // the workers end when the ready pipe is closed
+  auto work = [&]() {
+    Service_Request request;
+    int fd;
+    while(read_exactly(ready_fds[0], &fd, sizeof(fd)) == sizeof(fd)) {
+      bool keep = false;
+      try {
+        keep = serve_request(fd, fd, request, thresholds);
+      }
+      catch(const exception& e) {
+        cerr << "connection closed: " << e.what() << endl;
+      }
+      if(keep)
+        write_exactly(returned_fds[1], &fd, sizeof(fd));
+      else
+        close(fd);
+    }
+  };
+
+  vector<thread> pool;
+  for(uint i = 0; i < max(workers, 1u); i++)
+    pool.emplace_back(work);
+
+  // the listening socket and both pipes come first, then the idle connections
+  vector<pollfd> poll_fds = {{listen_fd, POLLIN, 0}, {returned_fds[0], POLLIN, 0}, {ready_fds[1], 0, 0}};
+  const size_t first_connection = 3;
+  // connections with a request which did not fit into the ready pipe yet
+  deque<int> ready_connections;
+  string error;
+  while(error.empty()) {
+    poll_fds[2].events = ready_connections.empty() ? 0 : POLLOUT;
+    if(poll(poll_fds.data(), poll_fds.size(), -1) < 0) {
+      if(errno != EINTR)
+        error = string("poll failed: ") + strerror(errno);
+      continue;
+    }
+
+    for(size_t i = first_connection; i < poll_fds.size();) {
+      if(poll_fds[i].revents != 0) {
+        ready_connections.push_back(poll_fds[i].fd);
+        poll_fds[i] = poll_fds.back();
+        poll_fds.pop_back();
+      }
+      else
+        i++;
+    }
+
+    if(poll_fds[0].revents != 0) {
+      int fd = accept(listen_fd, nullptr, nullptr);
+      if(fd >= 0)
+        poll_fds.push_back({fd, POLLIN, 0});
+      else if(errno != EINTR && errno != ECONNABORTED)
+        error = string("accept failed: ") + strerror(errno);
+    }
+
+    if(poll_fds[1].revents != 0) {
+      int fds[256];
+      ssize_t bytes_read;
+      while((bytes_read = read(returned_fds[0], fds, sizeof(fds))) > 0)
+        for(size_t i = 0; i < bytes_read / sizeof(int); i++)
+          poll_fds.push_back({fds[i], POLLIN, 0});
+    }
+
+    while(!ready_connections.empty()) {
+      int fd = ready_connections.front();
+      if(write(ready_fds[1], &fd, sizeof(fd)) != sizeof(fd))
+        break;
+      ready_connections.pop_front();
+    }
+  }
+
+  close(ready_fds[1]);
+  for(thread& worker : pool)
+    worker.join();
+
+  for(size_t i = first_connection; i < poll_fds.size(); i++)
+    close(poll_fds[i].fd);
+  for(int fd : ready_connections)
+    close(fd);
+  int fd;
+  while(read(returned_fds[0], &fd, sizeof(fd)) == sizeof(fd))
+    close(fd);
+  close(ready_fds[0]);
+  close(returned_fds[0]);
+  close(returned_fds[1]);
+  close(listen_fd);
+  throw runtime_error(error);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "types.hpp"
+#include "gap_backend.hpp"
+
+// binary protocol of the service, all values are 64 bit unsigned integers in native byte order
+// (the service only listens locally)
+// request: m, n, then n pairs of processing_time and required_machines
+// reply:   status, makespan, n, then the n starting times in the order of the request
+//          if status is not SERVICE_OK, n is the length of the error message which follows instead
+// a connection can send any number of requests, each one is answered before the next one is read
+const unsigned long long SERVICE_OK = 0;
+const unsigned long long SERVICE_ERROR = 1;
+
+// larger requests are answered with an error and the connection is closed
+const unsigned long long SERVICE_MAX_JOBS = 1ull << 26;
+
+struct Service_Request {
+  unsigned long long m;
+  vector<Raw_Job> raw_jobs;
+};
+
+struct Service_Reply {
+  unsigned long long status;
+  unsigned long long makespan;
+  vector<unsigned long long> starting_times;
+  string error;
+};
+
+// the jobs are checked against the widths of this build and tower scheduled with the selected backend
+Service_Reply handle_request(const Service_Request& request, const Backend_Thresholds& thresholds);
+
+// returns false at the end of the stream (throws if the stream ends within a request)
+bool read_request(int fd, Service_Request& request);
+
+void write_reply(int fd, const Service_Reply& reply);
+
+// reads and answers one request, returns false at the end of the stream or if the stream has to be closed
+// (throws if reading or writing fails)
+bool serve_request(int in_fd, int out_fd, Service_Request& request, const Backend_Thresholds& thresholds);
+
+// answers the requests of one stream until it ends (the buffers are reused between requests)
+void serve_stream(int in_fd, int out_fd, const Backend_Thresholds& thresholds);
+
+// listens on a unix domain socket at path (an existing socket is replaced, any other file is an error)
+// every request is answered by one of a pool of workers (a connection only holds a worker while it is answered),
+// does not return unless accepting or waiting for the connections fails
+void serve_unix_socket(const string& path, uint workers, const Backend_Thresholds& thresholds);
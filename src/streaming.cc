@@ -0,0 +1,238 @@
+#include "streaming.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <queue>
+#include <random>
+
+namespace fs = std::filesystem;
+
+// same bounds as Tower_Schedule::is_tiny_job and the others (without overflowing 4*required_machines)
+Job_Class get_job_class(Machines required_machines, Machines m) {
+  unsigned long long q = required_machines;
+  if(4*q <= m)
+    return Job_Class::tiny;
+  if(3*q <= m)
+    return Job_Class::small;
+  if(2*q <= m)
+    return Job_Class::medium;
+  return Job_Class::big;
+}
+
+// a job with its position in the instance
+struct Stream_Job {
+  unsigned long long index;
+  Time processing_time;
+  Machines required_machines;
+};
+
+// reads the jobs of an instance one by one
+class Instance_Reader {
+public:
+  Instance_Reader(const string& path, Machines m) : in(path), m(m) {
+    if(!in)
+      throw runtime_error("can not open " + path);
+  }
+
+  // false at the end of the instance
+  bool next(Raw_Job& raw_job) {
+    if(!(in >> raw_job.first >> raw_job.second))
+      return false;
+    if(raw_job.second > m)
+      throw out_of_range("job requires more than m machines");
+    return true;
+  }
+
+private:
+  ifstream in;
+  Machines m;
+};
+
+// new directory for the slices, removed with them at the end (also if scheduling throws)
+class Slice_Directory {
+public:
+  Slice_Directory(const string& parent_directory) {
+    fs::path parent = parent_directory.empty() ? fs::temp_directory_path() : fs::path(parent_directory);
+    random_device rd;
+    do
+      path = parent / ("pts_slices_" + to_string(rd()));
+    while(!fs::create_directory(path));
+  }
+
+  Slice_Directory(const Slice_Directory&) = delete;
+  Slice_Directory& operator=(const Slice_Directory&) = delete;
+
+  ~Slice_Directory() {
+    error_code error;
+    fs::remove_all(path, error);
+  }
+
+  fs::path path;
+};
+
+Streaming_Report schedule_stream(const string& instance_path, const string& output_path, Machines m,
+                                 const Streaming_Options& options, const Backend_Thresholds& thresholds) {
+  if(options.max_jobs_in_memory == 0)
+    throw invalid_argument("the streaming mode needs room for at least one job");
+  if(get_required_machine_bits(m) > PTS_MACHINE_BITS)
+    throw out_of_range("m needs " + to_string(get_required_machine_bits(m)) + " bit machines, this build has "
+                       + to_string(PTS_MACHINE_BITS));
+
+  Streaming_Report report = {0, 0, 0, {}, 0, 1.0};
+
+  // first pass: the classes, the longest job and the area
+  unsigned long long sum_of_processing_times = 0;
+  long double area = 0;
+  {
+    Instance_Reader reader(instance_path, m);
+    Raw_Job raw_job;
+    while(reader.next(raw_job)) {
+      auto [processing_time, required_machines] = raw_job;
+      sum_of_processing_times = checked_add(sum_of_processing_times, processing_time);
+      // every completion time is at most the sum of the processing times (as in get_required_time_bits)
+      if(sum_of_processing_times >= numeric_limits<Time>::max())
+        throw out_of_range("the sum of the processing times does not fit into the " + to_string(PTS_TIME_BITS)
+                           + " bit times of this build");
+      report.p_max = max(report.p_max, static_cast<Time>(processing_time));
+      area += static_cast<long double>(processing_time) * required_machines;
+      report.class_counts[static_cast<size_t>(get_job_class(required_machines, m))]++;
+      report.n++;
+    }
+  }
+
+  if(report.n == 0) {
+    ofstream create_output(output_path, ios::binary | ios::trunc);
+    if(!create_output)
+      throw runtime_error("can not open " + output_path);
+    return report;
+  }
+
+  // second pass: the buffer is sorted by slice and appended to the files of the slices
+  report.slices = (report.n + options.max_jobs_in_memory - 1) / options.max_jobs_in_memory;
+  Slice_Directory slice_directory(options.temporary_directory);
+  auto get_slice_path = [&](size_t slice) { return slice_directory.path / ("slice_" + to_string(slice)); };
+  {
+    // the slice of a job is kept in its index until the spill
+    vector<pair<size_t, Stream_Job>> buffer;
+    buffer.reserve(min<unsigned long long>(options.max_jobs_in_memory, report.n));
+    vector<Stream_Job> slice_jobs;
+    auto spill = [&]() {
+      sort(buffer.begin(), buffer.end(), [](const auto& j1, const auto& j2) { return j1.first < j2.first; });
+      for(auto first = buffer.begin(); first != buffer.end();) {
+        size_t slice = first->first;
+        slice_jobs.clear();
+        for(; first != buffer.end() && first->first == slice; first++)
+          slice_jobs.push_back(first->second);
+        ofstream out(get_slice_path(slice), ios::binary | ios::app);
+        out.write(reinterpret_cast<const char*>(slice_jobs.data()), slice_jobs.size() * sizeof(Stream_Job));
+        if(!out)
+          throw runtime_error("writing the slice " + get_slice_path(slice).string() + " failed");
+      }
+      buffer.clear();
+    };
+
+    array<unsigned long long, NUMBER_OF_JOB_CLASSES> dealt_jobs = {};
+    Instance_Reader reader(instance_path, m);
+    Raw_Job raw_job;
+    unsigned long long index = 0;
+    while(reader.next(raw_job)) {
+      if(index == report.n)
+        throw runtime_error("the instance changed between the passes");
+      Stream_Job job = {index++, static_cast<Time>(raw_job.first), static_cast<Machines>(raw_job.second)};
+      size_t slice = dealt_jobs[static_cast<size_t>(get_job_class(job.required_machines, m))]++ % report.slices;
+      buffer.push_back({slice, job});
+      if(buffer.size() == options.max_jobs_in_memory)
+        spill();
+    }
+    spill();
+    if(index != report.n)
+      throw runtime_error("the instance changed between the passes");
+  }
+
+  auto by_key = [](const Stream_Job& j1, const Stream_Job& j2) {
+    return make_pair(j1.processing_time, j1.required_machines) < make_pair(j2.processing_time, j2.required_machines);
+  };
+  auto by_job_key = [](const Job& j1, const Job& j2) {
+    return make_pair(j1.processing_time, j1.required_machines) < make_pair(j2.processing_time, j2.required_machines);
+  };
+
+  // every scheduled slice writes its starting times sorted by index into a run,
+  // the runs are merged into the output afterwards, so it is written sequentially
+  auto get_run_path = [&](size_t slice) { return slice_directory.path / ("starting_times_" + to_string(slice)); };
+  vector<size_t> runs;
+  vector<Stream_Job> slice_jobs;
+  Job_List jobs;
+  vector<pair<unsigned long long, unsigned long long>> starting_times;
+  for(size_t slice = 0; slice < report.slices; slice++) {
+    // a slice with fewer jobs than slices in every class is empty
+    if(!fs::exists(get_slice_path(slice)))
+      continue;
+    {
+      ifstream in(get_slice_path(slice), ios::binary);
+      slice_jobs.resize(fs::file_size(get_slice_path(slice)) / sizeof(Stream_Job));
+      in.read(reinterpret_cast<char*>(slice_jobs.data()), slice_jobs.size() * sizeof(Stream_Job));
+      if(!in)
+        throw runtime_error("reading the slice " + get_slice_path(slice).string() + " failed");
+    }
+    fs::remove(get_slice_path(slice));
+
+    jobs.clear();
+    for(const Stream_Job& job : slice_jobs)
+      jobs.emplace_back(job.processing_time, job.required_machines);
+    Tower_Result result = schedule_with_selected_backend(m, jobs, thresholds);
+
+    // identical jobs are interchangeable, so the placed jobs are matched to the slice by their sizes
+    // (as in handle_request)
+    sort(slice_jobs.begin(), slice_jobs.end(), by_key);
+    sort(result.placed_jobs.begin(), result.placed_jobs.end(), by_job_key);
+    starting_times.resize(slice_jobs.size());
+    for(size_t i = 0; i < slice_jobs.size(); i++)
+      starting_times[i] = {slice_jobs[i].index, checked_add(report.makespan, result.placed_jobs[i].starting_time.value())};
+    sort(starting_times.begin(), starting_times.end());
+    ofstream run(get_run_path(slice), ios::binary);
+    run.write(reinterpret_cast<const char*>(starting_times.data()), starting_times.size() * sizeof(starting_times[0]));
+    if(!run)
+      throw runtime_error("writing the run " + get_run_path(slice).string() + " failed");
+    runs.push_back(slice);
+
+    report.makespan = checked_add(report.makespan, result.makespan);
+  }
+
+  // k-way merge of the runs, the heap holds the next starting time of every run
+  {
+    vector<ifstream> run_files;
+    run_files.reserve(runs.size());
+    using Run_Head = tuple<unsigned long long, unsigned long long, size_t>;
+    priority_queue<Run_Head, vector<Run_Head>, greater<Run_Head>> heads;
+    auto read_head = [&](size_t run) {
+      pair<unsigned long long, unsigned long long> starting_time;
+      if(run_files[run].read(reinterpret_cast<char*>(&starting_time), sizeof(starting_time)))
+        heads.emplace(starting_time.first, starting_time.second, run);
+    };
+    for(size_t run = 0; run < runs.size(); run++) {
+      run_files.emplace_back(get_run_path(runs[run]), ios::binary);
+      read_head(run);
+    }
+
+    ofstream output(output_path, ios::binary | ios::trunc);
+    if(!output)
+      throw runtime_error("can not open " + output_path);
+    unsigned long long next_index = 0;
+    while(!heads.empty()) {
+      auto [index, starting_time, run] = heads.top();
+      heads.pop();
+      if(index != next_index++)
+        throw runtime_error("the runs of the starting times are incomplete");
+      output.write(reinterpret_cast<const char*>(&starting_time), sizeof(starting_time));
+      read_head(run);
+    }
+    if(next_index != report.n)
+      throw runtime_error("the runs of the starting times are incomplete");
+    if(!output)
+      throw runtime_error("writing " + output_path + " failed");
+  }
+
+  double lower_bound = max<double>(m == 0 ? 0 : area / m, report.p_max);
+  report.ratio = lower_bound == 0 ? 1.0 : report.makespan / lower_bound;
+  return report;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "types.hpp"
+#include "gap_backend.hpp"
+
+#include <array>
+
+// classes of the tower schedule (required machines up to m/4, m/3, m/2 and above)
+enum class Job_Class { tiny, small, medium, big };
+
+const size_t NUMBER_OF_JOB_CLASSES = 4;
+
+Job_Class get_job_class(Machines required_machines, Machines m);
+
+struct Streaming_Options {
+  // jobs held in memory at once (the buffer of the second pass and a slice while scheduling, up to 3 more)
+  size_t max_jobs_in_memory;
+  // the slices are written into a new directory in here, which is removed afterwards
+  // (the temporary directory of the system if empty)
+  string temporary_directory;
+};
+
+const Streaming_Options DEFAULT_STREAMING_OPTIONS = {
+  /*max_jobs_in_memory=*/1 << 20,
+  /*temporary_directory=*/""
+};
+
+struct Streaming_Report {
+  unsigned long long n;
+  Time makespan;
+  Time p_max;
+  // indexed by Job_Class
+  array<unsigned long long, NUMBER_OF_JOB_CLASSES> class_counts;
+  size_t slices;
+  // makespan / max(area/m, p_max)
+  double ratio;
+};
+
+// for instances which do not fit into memory as a Job_List:
+// the first pass over the instance counts the jobs of every class (and checks them against the widths of this build),
+// which gives the number of slices of at most max_jobs_in_memory jobs
+// the second pass deals the jobs of every class in turn to the slices (the i-th job of a class goes to slice i mod slices),
+// so every slice is a small copy of the instance, and spills them into one file per slice
+// the slices are tower scheduled one after another (with the selected backend) on top of each other,
+// so the makespan is the sum of the makespans of the slices
+// the starting times of every slice are spilled sorted by index and merged into the output at the end
+// instance: one job per line, processing time and required machines (as written by save_instance)
+// output:   the starting times as 64 bit unsigned integers in native byte order, in the order of the instance
+Streaming_Report schedule_stream(const string& instance_path, const string& output_path, Machines m,
+                                 const Streaming_Options& options = DEFAULT_STREAMING_OPTIONS,
+                                 const Backend_Thresholds& thresholds = DEFAULT_BACKEND_THRESHOLDS);
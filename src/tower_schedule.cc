@@ -1,121 +1,340 @@
 #include "tower_schedule.hpp"
 
-Tower_Schedule::Tower_Schedule(uint m, uint n) 
-    : m(m), n(n), sigma1(m,n), sigma2(m,n), sigma(m,n)
+#include <numeric>
+#include <thread>
+
+template<Gap_Structure GM>
+Basic_Tower_Schedule<GM>::Basic_Tower_Schedule(Machines m, uint n) 
+    : sigma1(m,n), sigma2(m,n), sigma(m,n), m(m), n(n), total_area(0), p_max(0), full_schedule_ratio(1.0)
   {}
 
-bool Tower_Schedule::is_tiny_job(Job job) {
+template<Gap_Structure GM>
+bool Basic_Tower_Schedule<GM>::is_tiny_job(Job job) {
   return 4*job.required_machines <= m;
 }
 
-bool Tower_Schedule::is_small_job(Job job) {
+template<Gap_Structure GM>
+bool Basic_Tower_Schedule<GM>::is_small_job(Job job) {
   return m < 4*job.required_machines && 3*job.required_machines <= m;
 }
 
-bool Tower_Schedule::is_medium_job(Job job) {
+template<Gap_Structure GM>
+bool Basic_Tower_Schedule<GM>::is_medium_job(Job job) {
   return m < 3*job.required_machines && 2*job.required_machines <= m;
 }
 
-bool Tower_Schedule::is_big_job(Job job) {
+template<Gap_Structure GM>
+bool Basic_Tower_Schedule<GM>::is_big_job(Job job) {
   return m < 2*job.required_machines;
 }
 
 
 
-void Tower_Schedule::schedule_jobs(Job_List jobs) {
-  uint p_max = 0;
-  for(const auto& job : jobs)
-    p_max = max(p_max, job.processing_time);
+template<Gap_Structure GM>
+void Basic_Tower_Schedule<GM>::schedule_jobs(Job_List jobs) {
+  schedule_jobs(to_job_groups(jobs));
+}
+
+template<Gap_Structure GM>
+void Basic_Tower_Schedule<GM>::schedule_jobs(const Job_Group_List& groups) {
+  schedule_jobs(groups, /*speculative=*/false);
+}
+
+template<Gap_Structure GM>
+void Basic_Tower_Schedule<GM>::schedule_jobs_speculatively(Job_List jobs) {
+  schedule_jobs_speculatively(to_job_groups(jobs));
+}
 
+template<Gap_Structure GM>
+void Basic_Tower_Schedule<GM>::schedule_jobs_speculatively(const Job_Group_List& groups) {
+  schedule_jobs(groups, /*speculative=*/true);
+}
+
+template<Gap_Structure GM>
+void Basic_Tower_Schedule<GM>::schedule_jobs(const Job_Group_List& groups, bool speculative) {
+  for(const auto& group : groups) {
+    p_max = max(p_max, group.job.processing_time);
+    total_area = checked_add(total_area, checked_multiply<unsigned long long>(
+                   checked_multiply<unsigned long long>(group.job.processing_time, group.job.required_machines), group.count));
+  }
 
-  partition_jobs(jobs); 
+  partition_jobs(groups); 
 
   sigma1.list_schedule(big_jobs);
 
+  Job_List expanded_medium_jobs = expand_job_groups(medium_jobs);
+  Job_List expanded_small_jobs = expand_job_groups(small_jobs);
+  medium_jobs = {};
+  small_jobs = {};
   Job_List remaining_medium_and_small_jobs 
-    = sigma1.schedule_down(medium_jobs + small_jobs);
+    = sigma1.schedule_down(expanded_medium_jobs + expanded_small_jobs);
   bool skip_to_many_jobs;
-  uint separation_time = get_separation_time_from_sigma1(sigma1, p_max, skip_to_many_jobs); 
+  Time separation_time = get_separation_time_from_sigma1(sigma1, p_max, skip_to_many_jobs); 
   sigma1.list_schedule(tiny_jobs, /*until_t=*/separation_time); 
 
   sigma2.on_two_stacks(remaining_medium_and_small_jobs);
 
-  uint sigma2_makespan = sigma2.get_makespan();
+  Time sigma2_makespan = sigma2.get_makespan();
   sigma2.set_makespan(0);
   sigma2.list_schedule(tiny_jobs, /*until_t=*/sigma2_makespan);
-  uint highest_tiny_job_completion_time = sigma2.get_makespan();
+  Time highest_tiny_job_completion_time = sigma2.get_makespan();
   sigma2.set_makespan(sigma2_makespan);
   
-  if(tiny_jobs.size() != 0 || skip_to_many_jobs) { // many tiny jobs
-    Job_List small_and_medium_jobs = 
-      remove_small_and_medium_jobs(sigma1); 
-    
-    sint height_of_removed_jobs = static_cast<sint>(height(small_and_medium_jobs));
-
-    Job_List additional_tiny_jobs = remove_tiny_jobs(sigma2); 
-    tiny_jobs = tiny_jobs + additional_tiny_jobs;
-    sigma2.sort_in_higher_stack(small_and_medium_jobs);
-
-    Schedule::balanced_list_schedule(tiny_jobs, sigma1, sigma2, /*balance_height=*/height_of_removed_jobs);
-
-    sigma.place_schedule_on_top(sigma1);
-    sigma2 = sigma2.get_rotated_schedule();
-    sigma.place_schedule_on_top(sigma2);
-  } else { // few or several tiny jobs
-    Schedule sigma1T(m,n), sigma1B(m,n);
-    sigma1.split_at(separation_time, sigma1T, sigma1B);       
-
-    Job_List removed_jobs = sigma2.remove_jobs_above(highest_tiny_job_completion_time);
-    
-    sigma2.list_schedule(removed_jobs);
-
-    sigma.place_schedule_on_top(sigma1B);
-    sigma.place_schedule_on_top(sigma2);
-    sigma.place_schedule_on_top(sigma1T);
+  bool many_tiny_jobs = tiny_jobs.size() != 0 || skip_to_many_jobs;
+  if(speculative) {
+    // the threads work on separate copies, exceptions are passed on after both finished
+    Basic_Tower_Schedule few_tiny_jobs_schedule = get_copy();
+    exception_ptr error;
+    thread few_tiny_jobs_thread([&]() {
+      try {
+        few_tiny_jobs_schedule.schedule_few_tiny_jobs(separation_time, highest_tiny_job_completion_time);
+      }
+      catch(...) {
+        error = current_exception();
+      }
+    });
+    schedule_many_tiny_jobs();
+    few_tiny_jobs_thread.join();
+    if(error)
+      rethrow_exception(error);
+
+    // the finishing which is not the one of the condition below is only taken if it is shorter
+    // (both list schedule their blocks into sigma, so both are feasible)
+    Time few_tiny_jobs_makespan = few_tiny_jobs_schedule.sigma.get_makespan();
+    bool take_few_tiny_jobs = many_tiny_jobs
+      ? few_tiny_jobs_makespan < sigma.get_makespan()
+      : !(sigma.get_makespan() < few_tiny_jobs_makespan);
+    if(take_few_tiny_jobs)
+      *this = move(few_tiny_jobs_schedule);
   }
+  else if(many_tiny_jobs) // many tiny jobs
+    schedule_many_tiny_jobs();
+  else // few or several tiny jobs
+    schedule_few_tiny_jobs(separation_time, highest_tiny_job_completion_time);
+
+  double lower_bound = get_lower_bound();
+  full_schedule_ratio = lower_bound == 0 ? 1.0 : sigma.get_makespan() / lower_bound;
+}
+
+template<Gap_Structure GM>
+void Basic_Tower_Schedule<GM>::schedule_many_tiny_jobs() {
+  // unscheduling lowers the makespan to the end of the remaining jobs,
+  // but balanced list scheduling keeps the tiny jobs below the makespan sigma1 had with the removed jobs
+  Time sigma1_makespan = sigma1.get_makespan();
+  Job_List small_and_medium_jobs = 
+    remove_small_and_medium_jobs(sigma1); 
+  sigma1.set_makespan(sigma1_makespan);
+  
+  Time_Difference height_of_removed_jobs = static_cast<Time_Difference>(height(small_and_medium_jobs));
+
+  Job_List additional_tiny_jobs = remove_tiny_jobs(sigma2); 
+  Job_Group_List additional_tiny_groups = to_job_groups(additional_tiny_jobs);
+  tiny_jobs.insert(tiny_jobs.end(), additional_tiny_groups.begin(), additional_tiny_groups.end());
+  sigma2.sort_in_higher_stack(small_and_medium_jobs);
+
+  Schedule::balanced_list_schedule(tiny_jobs, sigma1, sigma2, /*balance_height=*/height_of_removed_jobs);
+
+  sigma.place_schedule_on_top(sigma1);
+  sigma.place_schedule_on_top(sigma2.get_rotated_view());
+  sigma2 = Schedule(m,n);
+}
+
+template<Gap_Structure GM>
+void Basic_Tower_Schedule<GM>::schedule_few_tiny_jobs(Time separation_time, Time highest_tiny_job_completion_time) {
+  Schedule sigma1T(m,n), sigma1B(m,n);
+  sigma1.split_at(separation_time, sigma1T, sigma1B);       
+
+  Job_List removed_jobs = sigma2.remove_jobs_above(highest_tiny_job_completion_time);
+  
+  sigma2.list_schedule(removed_jobs);
+
+  sigma.place_schedule_on_top(sigma1B);
+  sigma.place_schedule_on_top(sigma2);
+  sigma.place_schedule_on_top(sigma1T);
+
+  // only if the branch was forced
+  if(!tiny_jobs.empty())
+    sigma.list_schedule(tiny_jobs);
+}
+
+template<Gap_Structure GM>
+bool Basic_Tower_Schedule<GM>::add_jobs(const Job_List& jobs, double slack) {
+  return add_jobs(to_job_groups(jobs), slack);
 }
 
-void Tower_Schedule::partition_jobs(Job_List jobs) {
+template<Gap_Structure GM>
+bool Basic_Tower_Schedule<GM>::add_jobs(const Job_Group_List& groups, double slack) {
+  if(sigma.placed_jobs.empty()) {
+    schedule_jobs(groups);
+    return true;
+  }
+
+  uint additional_jobs = 0;
+  for(const auto& group : groups)
+    additional_jobs += group.count;
+
+  Basic_Tower_Schedule additional_schedule(m, additional_jobs);
+  additional_schedule.schedule_jobs(groups);
+  p_max = max(p_max, additional_schedule.p_max);
+  total_area = checked_add(total_area, additional_schedule.total_area);
+  n += additional_jobs;
+
+  // the jobs which are already placed are not moved, the cursor of sigma only goes up
+  sigma.place_schedule_on_top(additional_schedule.sigma);
+  if(sigma.get_makespan() <= (1 + slack) * full_schedule_ratio * get_lower_bound())
+    return false;
+
+  // the invariant is broken, so everything is scheduled again
+  Job_List jobs = sigma.placed_jobs;
+  for(Job& job : jobs)
+    job.starting_time.reset();
+
+  *this = Basic_Tower_Schedule(m, n);
+  schedule_jobs(group_jobs(jobs));
+  return true;
+}
+
+template<Gap_Structure GM>
+Time Basic_Tower_Schedule<GM>::compact() {
+  sigma.compact();
+  double lower_bound = get_lower_bound();
+  full_schedule_ratio = lower_bound == 0 ? 1.0 : sigma.get_makespan() / lower_bound;
+  return sigma.get_makespan();
+}
+
+template<Gap_Structure GM>
+Time Basic_Tower_Schedule<GM>::cancel_job(uint job_index, uint max_moves) {
+  const Job& job = sigma.placed_jobs.at(job_index);
+  total_area -= static_cast<unsigned long long>(job.processing_time) * job.required_machines;
+  n--;
+  return sigma.cancel_job(job_index, max_moves);
+}
+
+template<Gap_Structure GM>
+Time Basic_Tower_Schedule<GM>::cancel_job_by_id(uint id, uint max_moves) {
+  return cancel_job(sigma.get_job_position(id), max_moves);
+}
+
+// jobs with the same rounded processing time and required machines are interchangeable,
+// so every placed copy can take the original values of any of them
+template<Gap_Structure GM>
+Rounding_Report Basic_Tower_Schedule<GM>::schedule_jobs_rounded(const Job_List& jobs, const Processing_Time_Rounding& rounding,
+                                                                const Machine_Rounding& machine_rounding) {
+  Job_List rounded_jobs = round_required_machines(round_processing_times(jobs, rounding), m, machine_rounding);
+  auto key = [](const Job& job) { return make_pair(job.processing_time, job.required_machines); };
+
+  // runs of equal rounded jobs become groups (sorted by key),
+  // the original jobs of group g start at first_original_job[g]
+  vector<size_t> order(jobs.size());
+  iota(order.begin(), order.end(), 0);
+  sort(order.begin(), order.end(), [&](size_t i, size_t j) { return key(rounded_jobs[i]) < key(rounded_jobs[j]); });
+
+  Job_Group_List groups;
+  vector<size_t> first_original_job;
+  Job_List original_jobs;
+  original_jobs.reserve(jobs.size());
+  long double area = 0, rounded_area = 0;
+  for(size_t i : order) {
+    if(groups.empty() || key(groups.back().job) != key(rounded_jobs[i])) {
+      groups.push_back(Job_Group{rounded_jobs[i], 0});
+      first_original_job.push_back(original_jobs.size());
+    }
+    groups.back().count++;
+    original_jobs.push_back(jobs[i]);
+    area += static_cast<long double>(jobs[i].processing_time) * jobs[i].required_machines;
+    rounded_area += static_cast<long double>(rounded_jobs[i].processing_time) * rounded_jobs[i].required_machines;
+  }
+
+  schedule_jobs(groups);
+  Time rounded_makespan = sigma.get_makespan();
+
+  for(Job& job : sigma.placed_jobs) {
+    auto group = lower_bound(groups.begin(), groups.end(), key(job),
+                             [&](const Job_Group& g, pair<Time, Machines> k) { return key(g.job) < k; });
+    const Job& original_job = original_jobs[first_original_job[group - groups.begin()]++];
+    job.processing_time = original_job.processing_time;
+    job.required_machines = original_job.required_machines;
+  }
+
+  // the gaps, the area and the ratio are the ones of the original jobs again
+  // (later changes of sigma free the original values of the jobs)
+  sigma.rebuild_gaps();
+  Time makespan = sigma.get_makespan();
+  p_max = 0;
+  total_area = 0;
+  for(const Job& job : jobs) {
+    p_max = max(p_max, job.processing_time);
+    total_area = checked_add(total_area, checked_multiply<unsigned long long>(job.processing_time, job.required_machines));
+  }
+  double full_lower_bound = get_lower_bound();
+  full_schedule_ratio = full_lower_bound == 0 ? 1.0 : makespan / full_lower_bound;
+
+  // distinct values of the original and rounded jobs
+  auto count_distinct = [](vector<unsigned long long> values) {
+    sort(values.begin(), values.end());
+    return static_cast<size_t>(unique(values.begin(), values.end()) - values.begin());
+  };
+  vector<unsigned long long> processing_times, rounded_processing_times, required_machines, rounded_required_machines;
+  for(size_t i = 0; i < jobs.size(); i++) {
+    processing_times.push_back(jobs[i].processing_time);
+    rounded_processing_times.push_back(rounded_jobs[i].processing_time);
+    required_machines.push_back(jobs[i].required_machines);
+    rounded_required_machines.push_back(rounded_jobs[i].required_machines);
+  }
+
+  double lower_bound = get_makespan_lower_bound(jobs, m);
+  return Rounding_Report{
+    makespan, rounded_makespan, lower_bound, lower_bound == 0 ? 1.0 : makespan / lower_bound,
+    count_distinct(processing_times), count_distinct(rounded_processing_times),
+    count_distinct(required_machines), count_distinct(rounded_required_machines),
+    rounded_area == 0 ? 0.0 : static_cast<double>(1 - area / rounded_area)
+  };
+}
+
+template<Gap_Structure GM>
+void Basic_Tower_Schedule<GM>::partition_jobs(const Job_Group_List& groups) {
   tiny_jobs = {};
   small_jobs = {};
   medium_jobs = {};
   big_jobs = {};
 
-  for(const auto& job : jobs) {
-    if(is_tiny_job(job)) {
-      tiny_jobs.push_back(job);
+  for(const auto& group : groups) {
+    if(is_tiny_job(group.job)) {
+      tiny_jobs.push_back(group);
     }
 
-    else if(is_small_job(job)){
-      small_jobs.push_back(job);
+    else if(is_small_job(group.job)){
+      small_jobs.push_back(group);
     }
 
-    else if(is_medium_job(job)){
-      medium_jobs.push_back(job);
+    else if(is_medium_job(group.job)){
+      medium_jobs.push_back(group);
     }
 
-    else if(is_big_job(job)){
-      big_jobs.push_back(job);
+    else if(is_big_job(group.job)){
+      big_jobs.push_back(group);
     }
   }
-  jobs = {};
 
 }
 
-uint Tower_Schedule::height(Job_List jobs) {
-  uint sum = 0;
+template<Gap_Structure GM>
+Time Basic_Tower_Schedule<GM>::height(Job_List jobs) {
+  Time sum = 0;
   for(auto job : jobs) 
-    sum += job.processing_time;
+    sum = checked_add(sum, job.processing_time);
   return sum;
 }
 
-Job_List Tower_Schedule::remove_small_and_medium_jobs(Schedule& schedule) {
+template<Gap_Structure GM>
+Job_List Basic_Tower_Schedule<GM>::remove_small_and_medium_jobs(Schedule& schedule) {
     return schedule.remove_jobs_if([this](const Job& j) {
         return is_small_job(j) || is_medium_job(j);
     });
 }
 
-Job_List Tower_Schedule::remove_tiny_jobs(Schedule& schedule) {
+template<Gap_Structure GM>
+Job_List Basic_Tower_Schedule<GM>::remove_tiny_jobs(Schedule& schedule) {
     return schedule.remove_jobs_if([this](const Job& j) {
         return is_tiny_job(j);
     });
@@ -123,17 +342,40 @@ Job_List Tower_Schedule::remove_tiny_jobs(Schedule& schedule) {
 
 // find earliest time tau where machine usage is <= 2/3 m
 // if there is no such time tau=makespan
-uint Tower_Schedule::get_separation_time_from_sigma1(Schedule sigma1, uint p_max, bool& skip_to_many_jobs) {
-  sigma1.gap_manager->reset_structure();
+template<Gap_Structure GM>
+Time Basic_Tower_Schedule<GM>::get_separation_time_from_sigma1(const Schedule& sigma1, Time p_max, bool& skip_to_many_jobs) {
+  // both probes start at time 0 with their own cursor, sigma1 is not changed
+  const GM& gap_manager = *sigma1.gap_manager;
+
   Job biggest_small_job(/*processing_time=*/1, /*required_machines=*/m/3); 
-  uint tau = sigma1.gap_manager->update_earliest_time_to_place(biggest_small_job);
-  sigma1.gap_manager->reset_structure(); 
+  Gap_Cursor cursor = gap_manager.get_start_cursor();
+  Time tau = gap_manager.find_earliest_time_to_place(biggest_small_job, cursor);
 
   Job maximal_small_job(/*processing_time=*/p_max, /*required_machines=*/m/3); 
-  uint tau_prime = sigma1.gap_manager->update_earliest_time_to_place(maximal_small_job);
-  sigma1.gap_manager->reset_structure(); 
+  Gap_Cursor cursor_prime = gap_manager.get_start_cursor();
+  Time tau_prime = gap_manager.find_earliest_time_to_place(maximal_small_job, cursor_prime);
 
   skip_to_many_jobs = (tau == tau_prime && tau != sigma1.get_makespan());
   return tau;
 }
 
+template<Gap_Structure GM>
+Basic_Tower_Schedule<GM> Basic_Tower_Schedule<GM>::get_copy() const {
+  Basic_Tower_Schedule copy = *this;
+  copy.sigma1 = sigma1.get_copy();
+  copy.sigma2 = sigma2.get_copy();
+  copy.sigma = sigma.get_copy();
+  return copy;
+}
+
+// max(area/m, p_max) of all scheduled jobs
+template<Gap_Structure GM>
+double Basic_Tower_Schedule<GM>::get_lower_bound() const {
+  return max(static_cast<double>(total_area) / m, static_cast<double>(p_max));
+}
+
+template class Basic_Tower_Schedule<Gap_Manager>;
+template class Basic_Tower_Schedule<Map_Gap_Manager>;
+template class Basic_Tower_Schedule<Flat_Gap_Manager>;
+template class Basic_Tower_Schedule<Dense_Gap_Manager>;
+template class Basic_Tower_Schedule<Summed_Gap_Manager>;
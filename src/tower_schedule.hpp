@@ -3,24 +3,36 @@
 #include "types.hpp"
 #include "gap_manager.hpp"
 #include "schedule.hpp"
+#include "rounding.hpp"
 
 
-class Tower_Schedule {
+// GM is the gap structure of all schedules (see Gap_Structure), Tower_Schedule uses the pb_ds tree
+template<Gap_Structure GM>
+class Basic_Tower_Schedule {
 public:
+  typedef Basic_Schedule<GM> Schedule;
+
   Schedule sigma1;
   Schedule sigma2;
 
   Schedule sigma;
 
-  Job_List tiny_jobs;
-  Job_List small_jobs;
-  Job_List medium_jobs;
-  Job_List big_jobs;
+  // identical jobs stay grouped until they are placed
+  Job_Group_List tiny_jobs;
+  Job_Group_List small_jobs;
+  Job_Group_List medium_jobs;
+  Job_Group_List big_jobs;
 
-  uint m;
+  Machines m;
   uint n;
 
-  Tower_Schedule(uint m, uint n);
+  // area and longest job of all scheduled jobs, and makespan / max(area/m, p_max) of the last full schedule
+  // (add_jobs keeps the ratio of sigma within the slack of this one)
+  unsigned long long total_area;
+  Time p_max;
+  double full_schedule_ratio;
+
+  Basic_Tower_Schedule(Machines m, uint n);
 
   bool is_tiny_job(Job job);
 
@@ -32,9 +44,48 @@ public:
 
   void schedule_jobs(Job_List jobs);
 
-  void partition_jobs(Job_List jobs);
+  // the jobs are given as groups of identical jobs (see group_jobs)
+  void schedule_jobs(const Job_Group_List& groups);
+
+  // both finishings (many and few tiny jobs) are run on copies of the schedules after the shared steps,
+  // the few tiny jobs one on another thread, and the one with the shorter makespan is kept
+  // (if there are tiny jobs left, the few tiny jobs finishing list schedules them at the end)
+  void schedule_jobs_speculatively(Job_List jobs);
+
+  void schedule_jobs_speculatively(const Job_Group_List& groups);
+
+  // online: the new jobs are tower scheduled on their own and list scheduled into sigma from its cursor on
+  // (the jobs placed already are not moved), so the cost depends on the new jobs and the gaps at the top only
+  // if the makespan would exceed (1+slack) * full_schedule_ratio * the lower bound of all jobs,
+  // all jobs are scheduled again from scratch instead, returns if this happened
+  bool add_jobs(const Job_List& jobs, double slack = 0.1);
+
+  bool add_jobs(const Job_Group_List& groups, double slack = 0.1);
+
+  // optional post-pass: the jobs of sigma are moved down into the gaps between the blocks (see Schedule::compact),
+  // returns the new makespan
+  Time compact();
+
+  // cancels sigma.placed_jobs[job_index] with a local repair (see Schedule::cancel_job), returns the new makespan
+  // (p_max is kept, so the lower bound of add_jobs only becomes weaker)
+  Time cancel_job(uint job_index, uint max_moves = 64);
+
+  // cancel_job for the job with id (see Schedule::assign_job_ids)
+  Time cancel_job_by_id(uint id, uint max_moves = 64);
 
-  uint height(Job_List jobs);
+  // schedules the jobs with rounded processing times and required machines
+  // (grouped, see Processing_Time_Rounding and Machine_Rounding)
+  // the placed jobs of sigma get their original values back (they only end earlier or use fewer machines),
+  // and the gaps of sigma are built again from them
+  Rounding_Report schedule_jobs_rounded(const Job_List& jobs, const Processing_Time_Rounding& rounding,
+                                        const Machine_Rounding& machine_rounding = {Machine_Rounding::none, 0, 0});
+
+  // a copy of a tower schedule shares the gap structures, this one copies them too (see Schedule::get_copy)
+  Basic_Tower_Schedule get_copy() const;
+
+  void partition_jobs(const Job_Group_List& groups);
+
+  Time height(Job_List jobs);
 
   Job_List remove_small_and_medium_jobs(Schedule& schedule);
 
@@ -42,6 +93,18 @@ public:
 
   // find earliest time tau where machine usage is <= 2/3 m
   // if there is no such time tau=makespan
-  uint get_separation_time_from_sigma1(Schedule sigma1, uint p_max, bool& skip_to_many_jobs);
+  // (only const queries on sigma1, its cursor is not used)
+  Time get_separation_time_from_sigma1(const Schedule& sigma1, Time p_max, bool& skip_to_many_jobs);
+
+private:
+  double get_lower_bound() const;
+
+  void schedule_jobs(const Job_Group_List& groups, bool speculative);
+
+  void schedule_many_tiny_jobs();
+
+  void schedule_few_tiny_jobs(Time separation_time, Time highest_tiny_job_completion_time);
 
 };
+
+typedef Basic_Tower_Schedule<Gap_Manager> Tower_Schedule;
@@ -0,0 +1,76 @@
+#include "types.hpp"
+
+Job_Group_List to_job_groups(const Job_List& jobs) {
+  Job_Group_List groups;
+  groups.reserve(jobs.size());
+  for(const Job& job : jobs)
+    groups.push_back(Job_Group{job, 1});
+  return groups;
+}
+
+Job_Group_List group_jobs(const Job_List& jobs) {
+  Job_Group_List groups;
+  map<pair<Time, Machines>, size_t> group_index;
+  for(const Job& job : jobs) {
+    auto [it, inserted] = group_index.insert({{job.processing_time, job.required_machines}, groups.size()});
+    if(inserted)
+      groups.push_back(Job_Group{job, 1});
+    else
+      groups[it->second].count++;
+  }
+  return groups;
+}
+
+Job_List expand_job_groups(const Job_Group_List& groups) {
+  size_t number_of_jobs = 0;
+  for(const Job_Group& group : groups)
+    number_of_jobs += group.count;
+
+  Job_List jobs;
+  jobs.reserve(number_of_jobs);
+  for(const Job_Group& group : groups)
+    jobs.insert(jobs.end(), group.count, group.job);
+  return jobs;
+}
+
+// the largest value (max of the type) of Time is INVALID_TIME
+uint get_required_time_bits(const vector<Raw_Job>& raw_jobs) {
+  unsigned long long sum_of_processing_times = 0;
+  for(const Raw_Job& raw_job : raw_jobs)
+    sum_of_processing_times = checked_add(sum_of_processing_times, raw_job.first);
+
+  if(sum_of_processing_times < numeric_limits<uint16_t>::max())
+    return 16;
+  if(sum_of_processing_times < numeric_limits<uint32_t>::max())
+    return 32;
+  if(sum_of_processing_times < numeric_limits<uint64_t>::max())
+    return 64;
+  throw out_of_range("the sum of the processing times does not fit into 64 bits");
+}
+
+uint get_required_machine_bits(unsigned long long m) {
+  if(m <= static_cast<unsigned long long>(numeric_limits<int16_t>::max()))
+    return 16;
+  if(m <= static_cast<unsigned long long>(numeric_limits<int32_t>::max()))
+    return 32;
+  if(m <= static_cast<unsigned long long>(numeric_limits<int64_t>::max()))
+    return 64;
+  throw out_of_range("m does not fit into 64 bits");
+}
+
+Job_List make_checked_jobs(const vector<Raw_Job>& raw_jobs, unsigned long long m) {
+  uint time_bits = get_required_time_bits(raw_jobs);
+  uint machine_bits = get_required_machine_bits(m);
+  if(time_bits > PTS_TIME_BITS || machine_bits > PTS_MACHINE_BITS)
+    throw out_of_range("instance needs " + to_string(time_bits) + " bit times and " + to_string(machine_bits)
+                       + " bit machines, this build has " + to_string(PTS_TIME_BITS) + " and " + to_string(PTS_MACHINE_BITS));
+
+  Job_List jobs;
+  jobs.reserve(raw_jobs.size());
+  for(auto [processing_time, required_machines] : raw_jobs) {
+    if(required_machines > m)
+      throw out_of_range("job requires more than m machines");
+    jobs.emplace_back(static_cast<Time>(processing_time), static_cast<Machines>(required_machines));
+  }
+  return jobs;
+}
@@ -3,32 +3,73 @@
 #include <optional>
 #include <iostream>
 #include <vector>
+#include <array>
 #include <cstdint>
 #include <list>
 #include <set>
+#include <map>
 #include <algorithm>
 #include <memory>
 #include <ranges>
+#include <limits>
+#include <stdexcept>
 
-// order statistic tree
+// order statistic tree and red black tree with sums of the subtrees
 #include <ext/pb_ds/assoc_container.hpp>
 #include <ext/pb_ds/tree_policy.hpp>
 
 using namespace std;
-using namespace __gnu_pbds; // order statistic tree
+using namespace __gnu_pbds; // tree of the gaps
 
 typedef uint32_t uint;
-typedef int32_t sint;
+
+// unsigned and signed integer of a width of 16, 32 or 64 bits
+template<int bits> struct Integer_Width;
+template<> struct Integer_Width<16> { typedef uint16_t unsigned_type; typedef int16_t signed_type; };
+template<> struct Integer_Width<32> { typedef uint32_t unsigned_type; typedef int32_t signed_type; };
+template<> struct Integer_Width<64> { typedef uint64_t unsigned_type; typedef int64_t signed_type; };
+
+// widths of times and machines (set in CMakeLists.txt, the instance is checked when it is loaded)
+#ifndef PTS_TIME_BITS
+#define PTS_TIME_BITS 32
+#endif
+#ifndef PTS_MACHINE_BITS
+#define PTS_MACHINE_BITS 32
+#endif
+
+typedef Integer_Width<PTS_TIME_BITS>::unsigned_type Time;
+typedef Integer_Width<PTS_MACHINE_BITS>::unsigned_type Machines;
+// change of available machines (so m has to fit into the signed type)
+typedef Integer_Width<PTS_MACHINE_BITS>::signed_type Machine_Change;
+// difference of two times (wide enough for all widths of Time)
+typedef int64_t Time_Difference;
+
+// a+b and a*b, throw instead of wrapping around
+template<typename T>
+T checked_add(T a, T b) {
+  T result;
+  if(__builtin_add_overflow(a, b, &result))
+    throw overflow_error("integer overflow");
+  return result;
+}
+
+template<typename T>
+T checked_multiply(T a, T b) {
+  T result;
+  if(__builtin_mul_overflow(a, b, &result))
+    throw overflow_error("integer overflow");
+  return result;
+}
 
 class Job {
 public:
-  Job(uint processing_time, uint required_machines) 
+  Job(Time processing_time, Machines required_machines) 
     : processing_time(processing_time), required_machines(required_machines) {}
 
-  uint processing_time;
-  uint required_machines;
+  Time processing_time;
+  Machines required_machines;
 
-  optional<uint> starting_time;
+  optional<Time> starting_time;
 };
 
 inline std::vector<Job> operator+(std::vector<Job>& lhs, std::vector<Job>& rhs) {
@@ -52,10 +93,29 @@ inline std::vector<Job> operator+(std::vector<Job>& lhs, std::vector<Job>& rhs)
 
 typedef vector<Job> Job_List;
 
+// count identical copies of a job
+struct Job_Group {
+  Job job;
+  uint count;
+};
+
+typedef vector<Job_Group> Job_Group_List;
+
+// one group per job (in the order of the jobs)
+Job_Group_List to_job_groups(const Job_List& jobs);
+
+// one group per distinct pair of processing time and required machines (in the order of their first job)
+Job_Group_List group_jobs(const Job_List& jobs);
+
+Job_List expand_job_groups(const Job_Group_List& groups);
+
+// order of placed jobs in a schedule
+inline bool starts_before(const Job& j1, const Job& j2) {
+  return j1.starting_time < j2.starting_time || (j1.starting_time == j2.starting_time && j1.required_machines > j2.required_machines);
+}
+
 inline void sort_jobs_increasingly_by_starting_time(Job_List& jobs) {
-  sort(jobs.begin(), jobs.end(), [](const Job& j1, const Job& j2) {
-      return j1.starting_time < j2.starting_time || (j1.starting_time == j2.starting_time && j1.required_machines > j2.required_machines);
-  });
+  sort(jobs.begin(), jobs.end(), starts_before);
 }
 
 inline void sort_jobs_increasingly_by_starting_time_and_second_by_required_machines(Job_List& jobs) {
@@ -84,27 +144,169 @@ inline void print_jobs(Job_List jobs) {
 }
 
 struct Gap {
-  uint time;                // time where the gap occurs
-  sint additional_machines; // machines more available at that time than in the previous gap;
+  Time time;                          // time where the gap occurs
+  Machine_Change additional_machines; // machines more available at that time than in the previous gap;
+};
+
+// available machines in the time interval which ends at time
+// (used for the absolute gap structure, where no values are relative to previous ones)
+struct Absolute_Gap {
+  Time time;
+  Machines available_machines;
+};
+
+typedef vector<Absolute_Gap> Absolute_Gap_List;
+
+// position of a search in a gap structure: the current time and the available machines at that time
+// (a query with its own cursor does not change the structure, so several readers can share a profile)
+struct Gap_Cursor {
+  Time time;
+  Machines available_machines;
+};
+
+// keeps the sum of the changes in every subtree, so the available machines at a time are summed up in O(log n)
+// (like the ranks of tree_order_statistics_node_update, the tree updates the sums when it inserts, erases or joins)
+template<typename Node_CItr, typename Node_Itr, typename Cmp_Fn, typename _Alloc>
+class gap_sum_node_update {
+public:
+  typedef long long metadata_type;
+
+  // sum of the changes at all times up to time
+  long long get_prefix_sum(Time time) const {
+    long long sum = 0;
+    for(Node_CItr it = node_begin(); it != node_end();) {
+      if(time < (*it)->first)
+        it = it.get_l_child();
+      else {
+        sum += (*it)->second + get_sum(it.get_l_child());
+        it = it.get_r_child();
+      }
+    }
+    return sum;
+  }
+
+  // a change written through an iterator is not seen by the tree,
+  // so the sums on the path from the root to its time are updated afterwards
+  void update_sums_to(Time time) {
+    // a red black tree with 2^64 nodes is at most 128 high
+    array<Node_Itr, 128> path;
+    size_t length = 0;
+    for(Node_Itr it = node_begin(); it != node_end();) {
+      path[length++] = it;
+      if(time == (*it)->first)
+        break;
+      it = time < (*it)->first ? it.get_l_child() : it.get_r_child();
+    }
+    while(length > 0)
+      operator()(path[--length], node_end());
+  }
+
+protected:
+  void operator()(Node_Itr it, Node_CItr end) const {
+    Node_CItr left = it.get_l_child(), right = it.get_r_child();
+    const_cast<metadata_type&>(it.get_metadata()) = (*it)->second
+      + (left == end ? 0 : left.get_metadata()) + (right == end ? 0 : right.get_metadata());
+  }
+
+  virtual ~gap_sum_node_update() {}
+
+private:
+  long long get_sum(Node_CItr it) const {
+    return it == node_end() ? 0 : it.get_metadata();
+  }
+
+  virtual Node_CItr node_begin() const = 0;
+  virtual Node_Itr node_begin() = 0;
+  virtual Node_CItr node_end() const = 0;
+  virtual Node_Itr node_end() = 0;
 };
 
-// order statistic tree // TODO: replace with std::map
+// order statistic tree
 // has O(log n) for indexing, searching and insertion
-typedef tree<uint,                                  // key type
-             sint,                                  // value type
-             std::less<uint>,                       // sorting increasing
+typedef tree<Time,                                  // key type
+             Machine_Change,                        // value type
+             std::less<Time>,                       // sorting increasing
              rb_tree_tag,                           // tree type (red black tree)
              tree_order_statistics_node_update>     // log indexing
              indexed_tree_base;
 
-// extend structure 
-struct indexed_tree : public indexed_tree_base {
+// red black tree of the changes with the sums of its subtrees
+// has O(log n) for searching, insertion and prefix sums (keeping the sums makes building a schedule about 10% slower)
+typedef tree<Time,                                  // key type
+             Machine_Change,                        // value type
+             std::less<Time>,                       // sorting increasing
+             rb_tree_tag,                           // tree type (red black tree)
+             gap_sum_node_update>                   // log prefix sums
+             summed_tree_base;
 
-    inline bool key_exists(uint key) const {
+// sorted vector with the interface of an ordered map
+// insertion and deletion are linear, but there is no node overhead (meant for few gaps)
+class flat_gap_list {
+public:
+  typedef pair<Time, Machine_Change> value_type;
+  typedef vector<value_type>::iterator iterator;
+  typedef vector<value_type>::const_iterator const_iterator;
+
+  iterator begin() { return entries.begin(); }
+  iterator end() { return entries.end(); }
+  const_iterator begin() const { return entries.begin(); }
+  const_iterator end() const { return entries.end(); }
+
+  size_t size() const { return entries.size(); }
+  bool empty() const { return entries.empty(); }
+  void clear() { entries.clear(); }
+
+  iterator lower_bound(Time key) {
+    return std::lower_bound(entries.begin(), entries.end(), key, key_less);
+  }
+  const_iterator lower_bound(Time key) const {
+    return std::lower_bound(entries.begin(), entries.end(), key, key_less);
+  }
+
+  iterator find(Time key) {
+    auto it = lower_bound(key);
+    return it != end() && it->first == key ? it : end();
+  }
+  const_iterator find(Time key) const {
+    auto it = lower_bound(key);
+    return it != end() && it->first == key ? it : end();
+  }
+
+  pair<iterator, bool> insert(const value_type& value) {
+    auto it = lower_bound(value.first);
+    if(it != end() && it->first == value.first)
+      return {it, false};
+    return {entries.insert(it, value), true};
+  }
+
+  // appending (hint at the end) is constant
+  iterator insert(const_iterator hint, const value_type& value) {
+    if(hint == end() && (empty() || entries.back().first < value.first)) {
+      entries.push_back(value);
+      return prev(end());
+    }
+    return insert(value).first;
+  }
+
+  iterator erase(const_iterator it) { return entries.erase(it); }
+
+  Machine_Change& operator[](Time key) { return insert({key, 0}).first->second; }
+
+private:
+  static bool key_less(const value_type& entry, Time key) { return entry.first < key; }
+
+  vector<value_type> entries;
+};
+
+// extend structure (for all ordered maps from time to additional machines)
+template<typename Base>
+struct gap_map : public Base {
+
+    inline bool key_exists(Time key) const {
         return this->find(key) != this->end();
     }
 
-    inline optional<Gap> get_next_gap(uint current_time) {
+    inline optional<Gap> get_next_gap(Time current_time) const {
       // lower_bound returns the current key (if exists) or the next larger
       auto it = this->lower_bound(current_time);   
       if (it == this->end())
@@ -113,7 +315,7 @@ struct indexed_tree : public indexed_tree_base {
         return Gap{it->first, it->second}; // time, additional_machines
     }
     
-    inline optional<Gap> get_previous_gap(uint current_time) {
+    inline optional<Gap> get_previous_gap(Time current_time) const {
       auto it = this->lower_bound(current_time); 
       if(it != this->begin()) {
         auto smaller_it = std::prev(it);
@@ -124,5 +326,22 @@ struct indexed_tree : public indexed_tree_base {
     }
 };
 
-const uint INVALID_TIME = std::numeric_limits<uint>::max();
+typedef gap_map<indexed_tree_base> indexed_tree;
+typedef gap_map<summed_tree_base> summed_tree;
+typedef gap_map<map<Time, Machine_Change>> ordered_gap_map;
+typedef gap_map<flat_gap_list> flat_gap_map;
+
+const Time INVALID_TIME = std::numeric_limits<Time>::max();
+
+// processing time and required machines of a job as read from an instance (before the range check)
+typedef pair<unsigned long long, unsigned long long> Raw_Job;
+
+// smallest width (16, 32 or 64 bits) which can hold an instance
+// every completion time is at most the sum of the processing times (INVALID_TIME is reserved)
+// and m has to fit into Machine_Change
+uint get_required_time_bits(const vector<Raw_Job>& raw_jobs);
+uint get_required_machine_bits(unsigned long long m);
+
+// throws out_of_range if the instance needs wider times or machines than this build has
+Job_List make_checked_jobs(const vector<Raw_Job>& raw_jobs, unsigned long long m);
 
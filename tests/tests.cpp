@@ -4,12 +4,48 @@
 #include "../src/gap_manager.hpp"
 #include "../src/schedule.hpp"
 #include "../src/tower_schedule.hpp"
+#include "../src/gap_backend.hpp"
+#include "../src/machine_assignment.hpp"
+#include "../src/service.hpp"
+#include "../src/job_queue.hpp"
+#include "../src/anytime.hpp"
+#include "../src/portfolio.hpp"
+#include "../src/multi_start.hpp"
+#include "../src/streaming.hpp"
+
+#include <thread>
+#include <filesystem>
+#include <fstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
 
 // INDEX TREE
 TEST(Index_Tree_Tests, GetNextGap_GetsCorrectGap) {
 
 }
 
+// TYPES
+TEST(Types_Tests, MakeCheckedJobs_ChecksRangeOfInstance) {
+  EXPECT_EQ(get_required_time_bits({{60000, 1}, {5000, 1}}), 16);
+  EXPECT_EQ(get_required_time_bits({{60000, 1}, {6000, 1}}), 32);
+  EXPECT_EQ(get_required_time_bits({{1ull << 40, 1}}), 64);
+  EXPECT_EQ(get_required_machine_bits(32767), 16);
+  EXPECT_EQ(get_required_machine_bits(32768), 32);
+
+  Job_List jobs = make_checked_jobs({{3, 2}, {4, 5}}, 5);
+  ASSERT_EQ(jobs.size(), 2);
+  EXPECT_EQ(jobs[1].processing_time, 4);
+  EXPECT_EQ(jobs[1].required_machines, 5);
+
+  EXPECT_THROW(make_checked_jobs({{3, 6}}, 5), out_of_range);
+  if(PTS_TIME_BITS < 64) {
+    EXPECT_THROW(make_checked_jobs({{1ull << 40, 1}}, 5), out_of_range);
+  }
+  EXPECT_THROW(checked_add<uint16_t>(60000, 6000), overflow_error);
+}
+
 // GAP MANAGER
 TEST(Gap_Manager_Tests, GetEarliestTimeToPlace_ReturnsCorrectTime) {
   Gap_Manager gap_manager(100);
@@ -50,6 +86,34 @@ TEST(Gap_Manager_Tests, AddAdditionalMachinesAt_AddtionWorks) {
   }
 }
 
+TEST(Gap_Manager_Tests, AddAdditionalMachinesAt_ErasesZeroEntries) {
+  Gap_Manager gap_manager(50);
+  // two abutting jobs of the same width
+  gap_manager.place_job_at(Job(5, 20), 0);
+  gap_manager.place_job_at(Job(5, 20), 5);
+  EXPECT_FALSE(gap_manager.gaps.key_exists(5));
+  EXPECT_EQ(gap_manager.get_number_of_gaps(), 2);
+
+  // the entry at time 0 is kept
+  gap_manager.add_additional_machines_at(0, -30);
+  EXPECT_TRUE(gap_manager.gaps.key_exists(0));
+}
+
+TEST(Gap_Manager_Tests, EndsAboveTheLargestTimeThrow) {
+  Gap_Manager gap_manager(10);
+  Job job(/*processing_time=*/10, /*required_machines=*/5);
+  job.starting_time = numeric_limits<Time>::max() - 20;
+  gap_manager.place_jobs({job});
+
+  Job late_job = job;
+  late_job.starting_time = numeric_limits<Time>::max() - 5;
+  EXPECT_THROW(gap_manager.remove_jobs({late_job}), overflow_error);
+  EXPECT_THROW(gap_manager.place_jobs({late_job}), overflow_error);
+
+  // the change at time 20 of the stacked profile would be above the largest time
+  EXPECT_THROW(gap_manager.stack_gaps_on_top({Gap{0, 5}, Gap{20, 5}}, 20), overflow_error);
+}
+
 TEST(Gap_Manager_Tests, GetEarliestTimeToPlace_UpdatesAvailableMachinesInGapCorrectly) {
   Gap_Manager gap_manager(1000);
   EXPECT_EQ(gap_manager.available_machines_in_gap, 1000);
@@ -92,21 +156,267 @@ TEST(Gap_Manager_Tests, BuildInverseAbsoluteGapsWorks) {
 
   gap_manager.makespan = 8;
 
-  map<uint,uint> inverse_absolute_gaps = 
+  Absolute_Gap_List inverse_absolute_gaps = 
     gap_manager.build_inverse_absolute_gaps();
 
-  EXPECT_EQ(inverse_absolute_gaps[0], 10);
-  EXPECT_EQ(inverse_absolute_gaps[1],  8);
-  EXPECT_EQ(inverse_absolute_gaps[2], 10);
-  EXPECT_EQ(inverse_absolute_gaps[4],  6);
-  EXPECT_EQ(inverse_absolute_gaps[5],  4);
-  EXPECT_EQ(inverse_absolute_gaps[6],  7);
-  EXPECT_EQ(inverse_absolute_gaps[7],  5);
-  EXPECT_EQ(inverse_absolute_gaps[8],  4);
+  ASSERT_EQ(inverse_absolute_gaps.size(), 8);
+  EXPECT_EQ(inverse_absolute_gaps[0].time, 0);
+  EXPECT_EQ(inverse_absolute_gaps[0].available_machines, 10);
+  EXPECT_EQ(inverse_absolute_gaps[1].time, 1);
+  EXPECT_EQ(inverse_absolute_gaps[1].available_machines,  8);
+  EXPECT_EQ(inverse_absolute_gaps[2].time, 2);
+  EXPECT_EQ(inverse_absolute_gaps[2].available_machines, 10);
+  EXPECT_EQ(inverse_absolute_gaps[3].time, 4);
+  EXPECT_EQ(inverse_absolute_gaps[3].available_machines,  6);
+  EXPECT_EQ(inverse_absolute_gaps[4].time, 5);
+  EXPECT_EQ(inverse_absolute_gaps[4].available_machines,  4);
+  EXPECT_EQ(inverse_absolute_gaps[5].time, 6);
+  EXPECT_EQ(inverse_absolute_gaps[5].available_machines,  7);
+  EXPECT_EQ(inverse_absolute_gaps[6].time, 7);
+  EXPECT_EQ(inverse_absolute_gaps[6].available_machines,  5);
+  EXPECT_EQ(inverse_absolute_gaps[7].time, 8);
+  EXPECT_EQ(inverse_absolute_gaps[7].available_machines,  4);
+
+}
+
+TEST(Gap_Manager_Tests, PlaceJobsMergesChangesAtTheSameTime) {
+  Gap_Manager gap_manager(10);
+
+  Job J1(/*processing_time=*/2, /*required_machines=*/6);
+  J1.starting_time = 0;
+  Job J2(/*processing_time=*/3, /*required_machines=*/4);
+  J2.starting_time = 2;
+  Job J3(/*processing_time=*/1, /*required_machines=*/4);
+  J3.starting_time = 2;
+
+  gap_manager.place_jobs({J3, J1, J2});
+
+  EXPECT_EQ(gap_manager.get_makespan(), 5);
+  EXPECT_EQ(gap_manager.gaps[0],  4);
+  EXPECT_EQ(gap_manager.gaps[2], -2);
+  EXPECT_EQ(gap_manager.gaps[3],  4);
+  EXPECT_EQ(gap_manager.gaps[5],  4);
+  EXPECT_EQ(gap_manager.available_machines_in_gap, 4);
+
+  uint time = gap_manager.update_earliest_time_to_place(Job(1,6));
+  EXPECT_EQ(time, 3);
+}
+
+TEST(Gap_Manager_Tests, FindEarliestTimeToPlace_UsesOwnCursor) {
+  Gap_Manager gap_manager(10);
+  Job J1(/*processing_time=*/4, /*required_machines=*/8);
+  J1.starting_time = 0;
+  Job J2(/*processing_time=*/3, /*required_machines=*/5);
+  J2.starting_time = 4;
+  gap_manager.place_jobs({J1, J2});
+  gap_manager.reset_structure();
+
+  // several readers probe the same profile at once
+  const Gap_Manager& profile = gap_manager;
+  vector<uint> times(4);
+  vector<thread> readers;
+  for(uint i = 0; i < times.size(); i++)
+    readers.emplace_back([&, i]() {
+      Gap_Cursor cursor = profile.get_start_cursor();
+      times[i] = profile.find_earliest_time_to_place(Job(1, 3 + 3*(i%2)), cursor);
+    });
+  for(thread& reader : readers)
+    reader.join();
+  EXPECT_EQ(times, (vector<uint>{4, 7, 4, 7}));
+
+  // a cursor continues from its position, the cursor of the manager is not moved
+  Gap_Cursor cursor = profile.get_start_cursor();
+  EXPECT_EQ(profile.find_earliest_time_to_place(Job(1, 3), cursor), 4);
+  EXPECT_EQ(profile.find_earliest_time_to_place(Job(1, 2), cursor), 4);
+  EXPECT_EQ(gap_manager.current_time, 0);
+  EXPECT_EQ(gap_manager.available_machines_in_gap, 2);
+}
+
+TEST(Gap_Manager_Tests, DenseGapManagerMatchesTree) {
+  Gap_Manager tree(10);
+  Dense_Gap_Manager dense(10);
+
+  // blocks are skipped for J3 and J4
+  Job J1(/*processing_time=*/100, /*required_machines=*/6);
+  J1.starting_time = 0;
+  Job J2(/*processing_time=*/50, /*required_machines=*/3);
+  J2.starting_time = 100;
+  Job J3(/*processing_time=*/5, /*required_machines=*/9);
+  Job J4(/*processing_time=*/5, /*required_machines=*/5);
+  auto place = [&](auto& gap_manager) {
+    gap_manager.place_jobs({J1, J2});
+    EXPECT_EQ(gap_manager.update_earliest_time_to_place(J3), 150);
+    gap_manager.place_job_at(J3, 150);
+    gap_manager.reset_structure();
+    EXPECT_EQ(gap_manager.update_earliest_time_to_place(J4), 100);
+  };
+  place(tree);
+  place(dense);
+
+  EXPECT_EQ(dense.get_makespan(), tree.get_makespan());
+  EXPECT_EQ(dense.get_number_of_gaps(), tree.get_number_of_gaps());
+  vector<Gap> tree_gaps = tree.get_gaps(), dense_gaps = dense.get_gaps();
+  for(size_t i = 0; i < tree_gaps.size(); i++) {
+    EXPECT_EQ(dense_gaps[i].time, tree_gaps[i].time);
+    EXPECT_EQ(dense_gaps[i].additional_machines, tree_gaps[i].additional_machines);
+  }
 
+  Absolute_Gap_List tree_inverse = tree.build_inverse_absolute_gaps(), dense_inverse = dense.build_inverse_absolute_gaps();
+  ASSERT_EQ(dense_inverse.size(), tree_inverse.size());
+  for(size_t i = 0; i < tree_inverse.size(); i++) {
+    EXPECT_EQ(dense_inverse[i].time, tree_inverse[i].time);
+    EXPECT_EQ(dense_inverse[i].available_machines, tree_inverse[i].available_machines);
+  }
+
+  Job_List removed_jobs = {J3};
+  removed_jobs[0].starting_time = 150;
+  dense.remove_jobs(removed_jobs);
+  EXPECT_EQ(dense.get_makespan(), 150);
+}
+
+TEST(Gap_Manager_Tests, DenseGapManagerSkipsOverfullTimes) {
+  Dense_Gap_Manager dense(10);
+
+  // placed without a check, -4 machines are available in [2,4)
+  Job J1(/*processing_time=*/4, /*required_machines=*/8);
+  J1.starting_time = 0;
+  Job J2(/*processing_time=*/4, /*required_machines=*/6);
+  J2.starting_time = 2;
+  dense.place_jobs({J1, J2});
+
+  Job J3(/*processing_time=*/1, /*required_machines=*/3);
+  Gap_Cursor cursor = dense.get_start_cursor();
+  EXPECT_EQ(dense.find_earliest_time_to_place(J3, cursor), 4);
+  cursor = dense.get_cursor_at(2);
+  EXPECT_EQ(dense.find_earliest_time_to_place(J3, cursor), 4);
 }
 
 // SCHEDULE
+TEST(Gap_Manager_Tests, FindEarliestTimeToFit_ChecksWholeProcessingTime) {
+  Gap_Manager tree(10);
+  Dense_Gap_Manager dense(10);
+
+  // only 2 machines are free in [1,3)
+  Job J1(/*processing_time=*/2, /*required_machines=*/8);
+  J1.starting_time = 1;
+  Job J2(/*processing_time=*/2, /*required_machines=*/5);
+  auto find = [&](auto& gap_manager) {
+    gap_manager.place_jobs({J1});
+    Gap_Cursor cursor = gap_manager.get_start_cursor();
+    EXPECT_EQ(gap_manager.find_earliest_time_to_place(J2, cursor), 0);
+    cursor = gap_manager.get_start_cursor();
+    EXPECT_EQ(gap_manager.find_earliest_time_to_fit(J2, cursor), 3);
+    EXPECT_EQ(gap_manager.get_cursor_at(2).available_machines, 2);
+    EXPECT_EQ(gap_manager.get_cursor_at(0).available_machines, 10);
+
+    gap_manager.remove_job_at(J1, 1);
+    EXPECT_EQ(gap_manager.get_makespan(), 0);
+    cursor = gap_manager.get_start_cursor();
+    EXPECT_EQ(gap_manager.find_earliest_time_to_fit(J2, cursor), 0);
+  };
+  find(tree);
+  find(dense);
+}
+
+TEST(Gap_Manager_Tests, GetCursorAtUsesTheSumsOfTheTree) {
+  Summed_Gap_Manager tree(10);
+  Map_Gap_Manager map(10);
+
+  // changes written in place, erased, and joined in by stacking
+  auto update = [](auto& gap_manager) {
+    Job J1(/*processing_time=*/4, /*required_machines=*/3);
+    Job J2(/*processing_time=*/2, /*required_machines=*/5);
+    gap_manager.place_job_at(J1, 0);
+    gap_manager.place_job_at(J2, 2);
+    gap_manager.place_job_at(J1, 2);
+    gap_manager.remove_job_at(J1, 0);
+    gap_manager.stack_gaps_on_top({Gap{0, 4}, Gap{3, 6}}, 3);
+  };
+  update(tree);
+  update(map);
+
+  ASSERT_EQ(tree.get_makespan(), map.get_makespan());
+  for(Time time = 0; time <= tree.get_makespan(); time++)
+    EXPECT_EQ(tree.get_cursor_at(time).available_machines, map.get_cursor_at(time).available_machines) << time;
+}
+
+TEST(Schedule_Tests, CancelJobMovesLaterJobsDown) {
+  Job wide_job(2, 6), narrow_job(1, 3);
+  auto schedule_stacked = [&]() {
+    // placed in sorted order: the wide jobs at 0, 2 and 4 and the narrow job at 0
+    Schedule schedule(10, 4);
+    schedule.schedule_job(wide_job, 0);
+    schedule.schedule_job(narrow_job, 0);
+    schedule.schedule_job(wide_job, 2);
+    schedule.schedule_job(wide_job, 4);
+    return schedule;
+  };
+
+  Schedule schedule = schedule_stacked();
+  EXPECT_EQ(schedule.cancel_job(0), 4);
+  ASSERT_EQ(schedule.placed_jobs.size(), 3);
+  EXPECT_TRUE(is_sorted(schedule.placed_jobs.begin(), schedule.placed_jobs.end(), starts_before));
+  // the wide job from 2 moves in front of the narrow job
+  EXPECT_EQ(schedule.placed_jobs[0].starting_time, 0);
+  EXPECT_EQ(schedule.placed_jobs[0].required_machines, 6);
+  EXPECT_EQ(schedule.placed_jobs[1].starting_time, 0);
+  EXPECT_EQ(schedule.placed_jobs[2].starting_time, 2);
+
+  // the two moves go to the narrow job (which stays) and the next wide job
+  Schedule bounded_schedule = schedule_stacked();
+  EXPECT_EQ(bounded_schedule.cancel_job(0, /*max_moves=*/2), 6);
+  EXPECT_TRUE(is_sorted(bounded_schedule.placed_jobs.begin(), bounded_schedule.placed_jobs.end(), starts_before));
+  EXPECT_EQ(bounded_schedule.placed_jobs[0].starting_time, 0);
+  EXPECT_EQ(bounded_schedule.placed_jobs[1].starting_time, 0);
+  EXPECT_EQ(bounded_schedule.placed_jobs[2].starting_time, 4);
+}
+
+TEST(Schedule_Tests, CancelJobByIdFindsTheMovedJobs) {
+  Machines m = 40;
+  Job_List jobs;
+  for(uint i = 0; i < 300; i++)
+    jobs.emplace_back(1 + (i*7) % 17, 1 + (i*13) % m);
+  Basic_Tower_Schedule<Summed_Gap_Manager> tower_schedule(m, jobs.size());
+  tower_schedule.schedule_jobs(jobs);
+  Basic_Schedule<Summed_Gap_Manager>& sigma = tower_schedule.sigma;
+  sigma.assign_job_ids();
+  Job_List original_jobs = sigma.placed_jobs;
+
+  for(uint i = 0; i < 150; i++) {
+    uint id = (i*89) % 300;
+    if(!sigma.jobs_by_id[id].starting_time.has_value())
+      continue;
+    Time makespan = tower_schedule.cancel_job_by_id(id, /*max_moves=*/8);
+    EXPECT_EQ(makespan, sigma.get_makespan());
+    EXPECT_THROW(sigma.get_job_position(id), out_of_range);
+    ASSERT_TRUE(is_sorted(sigma.placed_jobs.begin(), sigma.placed_jobs.end(), starts_before));
+
+    // every remaining id still finds its job, which only moved down
+    for(uint other_id = 0; other_id < original_jobs.size(); other_id++) {
+      if(!sigma.jobs_by_id[other_id].starting_time.has_value())
+        continue;
+      const Job& job = sigma.placed_jobs[sigma.get_job_position(other_id)];
+      ASSERT_EQ(sigma.placed_job_ids[sigma.get_job_position(other_id)], other_id);
+      EXPECT_EQ(job.starting_time, sigma.jobs_by_id[other_id].starting_time);
+      EXPECT_EQ(job.processing_time, original_jobs[other_id].processing_time);
+      EXPECT_EQ(job.required_machines, original_jobs[other_id].required_machines);
+      EXPECT_LE(job.starting_time, original_jobs[other_id].starting_time);
+    }
+  }
+
+  // the gaps are the ones of the remaining jobs
+  Gap_Manager expected_gaps(m);
+  expected_gaps.place_jobs(sigma.placed_jobs);
+  EXPECT_EQ(sigma.get_makespan(), expected_gaps.get_makespan());
+  vector<Gap> gaps = sigma.gap_manager->get_gaps(), expected = expected_gaps.get_gaps();
+  ASSERT_EQ(gaps.size(), expected.size());
+  for(size_t i = 0; i < gaps.size(); i++) {
+    EXPECT_EQ(gaps[i].time, expected[i].time);
+    EXPECT_EQ(gaps[i].additional_machines, expected[i].additional_machines);
+  }
+  EXPECT_NO_THROW(assign_machines(sigma.placed_jobs, m));
+}
+
 TEST(Schedule_Tests, ListScheduleWorksCorrect) {
   // Job(processing_time, required_machines)
   Job_List jobs = {
@@ -143,6 +453,64 @@ TEST(Schedule_Tests, ListScheduleWorksCorrect) {
 }
 
 
+TEST(Schedule_Tests, ListScheduleMergesIntoPlacedJobs) {
+  Schedule schedule(10, 4);
+  Job_List jobs = {{2, 6}, {4, 6}};
+  schedule.list_schedule(jobs); // [0,4) and [4,6)
+
+  // the new jobs start together with the job at 4
+  jobs = {{1, 4}, {3, 4}};
+  schedule.list_schedule(jobs); // [4,7) and [6,7)
+
+  ASSERT_EQ(schedule.placed_jobs.size(), 4);
+  EXPECT_TRUE(is_sorted(schedule.placed_jobs.begin(), schedule.placed_jobs.end(), starts_before));
+  EXPECT_EQ(schedule.placed_jobs[0].starting_time.value(), 0);
+  EXPECT_EQ(schedule.placed_jobs[1].required_machines,    6);
+  EXPECT_EQ(schedule.placed_jobs[2].required_machines,    4);
+  EXPECT_EQ(schedule.placed_jobs[2].starting_time.value(), 4);
+  EXPECT_EQ(schedule.placed_jobs[3].starting_time.value(), 6);
+}
+
+TEST(Schedule_Tests, ListScheduleGroupPlacesFittingCopiesAtOnce) {
+  Schedule schedule(10, 7);
+  Job_Group_List groups = {{Job(2, 3), 5}, {Job(4, 1), 2}};
+  schedule.list_schedule(groups);
+
+  // three copies next to each other and one narrow job at time 0, the same with two copies at time 2
+  ASSERT_EQ(schedule.placed_jobs.size(), 7);
+  EXPECT_EQ(schedule.placed_jobs[2].starting_time.value(), 0);
+  EXPECT_EQ(schedule.placed_jobs[2].required_machines, 3);
+  EXPECT_EQ(schedule.placed_jobs[3].starting_time.value(), 0);
+  EXPECT_EQ(schedule.placed_jobs[3].required_machines, 1);
+  EXPECT_EQ(schedule.placed_jobs[5].starting_time.value(), 2);
+  EXPECT_EQ(schedule.placed_jobs[5].required_machines, 3);
+  EXPECT_EQ(schedule.get_makespan(), 6);
+  EXPECT_TRUE(groups.empty());
+
+  // the same schedule as with the expanded jobs
+  Schedule expanded_schedule(10, 7);
+  Job_List jobs = expand_job_groups({{Job(2, 3), 5}, {Job(4, 1), 2}});
+  expanded_schedule.list_schedule(jobs);
+  EXPECT_EQ(expanded_schedule.gap_manager->get_number_of_gaps(), schedule.gap_manager->get_number_of_gaps());
+  for(size_t i = 0; i < jobs.size(); i++)
+    EXPECT_EQ(expanded_schedule.placed_jobs[i].starting_time, schedule.placed_jobs[i].starting_time);
+}
+
+TEST(Schedule_Tests, ListScheduleDoesNotOverfillBelowJobsStartingLater) {
+  uint m = 10;
+  Schedule schedule(m, 2);
+  // the cursor stays at 0, the job at 2 starts above it
+  Job wide_job(/*processing_time=*/2, /*required_machines=*/8);
+  schedule.schedule_job(wide_job, 2);
+
+  // 10 machines at time 0, but only 2 from time 2 on: the long job has to wait for the end of the wide one
+  Job_List jobs = {Job(/*processing_time=*/5, /*required_machines=*/5)};
+  schedule.list_schedule(jobs);
+  ASSERT_EQ(schedule.placed_jobs.size(), 2);
+  EXPECT_EQ(schedule.placed_jobs[1].starting_time, 4);
+  EXPECT_NO_THROW(assign_machines(schedule.placed_jobs, m));
+}
+
 TEST(Schedule_Tests, OnTwoStackWorksCorrect) {
   // Job(processing_time, required_machines)
   Job_List jobs = {
@@ -173,10 +541,31 @@ TEST(Schedule_Tests, OnTwoStackWorksCorrect) {
 }
 
 
+TEST(Schedule_Tests, OnTwoStacksStartsAtMakespan) {
+  uint m = 100;
+  Schedule schedule(m, 4);
+  Job J0(/*processing_time=*/5, /*required_machines=*/100);
+  schedule.schedule_job(J0, 0);
+
+  Job_List jobs = {
+    {10, 50}, 
+    {20, 40}, 
+    {10, 30}  
+  };
+  schedule.on_two_stacks(jobs);
+
+  EXPECT_EQ(schedule.get_makespan(), 25);
+  EXPECT_EQ(schedule.placed_jobs[1].starting_time.value(), 5);  // second stack
+  EXPECT_EQ(schedule.placed_jobs[2].starting_time.value(), 5);  // first stack
+  EXPECT_EQ(schedule.placed_jobs[3].starting_time.value(), 15); // second stack ends first
+  EXPECT_EQ(schedule.gap_manager->gaps[5], 10);
+  EXPECT_EQ(schedule.gap_manager->gaps[15], 20);
+}
+
 class Mock_Gap_Manager : public Gap_Manager {
 public:
     Mock_Gap_Manager(uint m) : Gap_Manager(m) {}
-    MOCK_METHOD((std::map<uint, uint>), build_inverse_absolute_gaps, (), (override));
+    MOCK_METHOD(Absolute_Gap_List, build_inverse_absolute_gaps, (), (override));
 };
 
 TEST(Schedule_Tests, ScheduleDownWorksCorrect) {
@@ -190,13 +579,14 @@ TEST(Schedule_Tests, ScheduleDownWorksCorrect) {
     Job(1, 1)   // J7  
   };
 
-  map<uint,uint> inverse_absolute_gaps;
-  inverse_absolute_gaps[0] = 11;
-  inverse_absolute_gaps[1] = 10;
-  inverse_absolute_gaps[3] =  8;
-  inverse_absolute_gaps[5] =  4;
-  inverse_absolute_gaps[7] =  2;
-  inverse_absolute_gaps[9] =  0;
+  Absolute_Gap_List inverse_absolute_gaps = {
+    {/*time=*/0, /*available_machines=*/11},
+    {/*time=*/1, /*available_machines=*/10},
+    {/*time=*/3, /*available_machines=*/ 8},
+    {/*time=*/5, /*available_machines=*/ 4},
+    {/*time=*/7, /*available_machines=*/ 2},
+    {/*time=*/9, /*available_machines=*/ 0}
+  };
 
   auto gap_manager = make_shared<Mock_Gap_Manager>(11);
   EXPECT_CALL(*gap_manager, build_inverse_absolute_gaps())
@@ -257,7 +647,7 @@ TEST(Schedule_Tests, ScheduleAndUnschedule) {
     Job(3, 2),  // J6  
     Job(1, 1)   // J7  
   };
-  uint m = 10;
+  Machines m = 10;
   uint n = 7;
 
   Schedule schedule(m, n);
@@ -325,6 +715,27 @@ TEST(Schedule_Tests, ScheduleAndUnschedule) {
   EXPECT_EQ(J4.starting_time.value(), 4);
 }
 
+TEST(Schedule_Tests, UnscheduleAbuttingJobs) {
+  Job_List jobs = {Job(2, 4), Job(3, 4)};
+  jobs[0].starting_time = 0;
+  jobs[1].starting_time = 2;
+
+  Schedule schedule(10, 2);
+  schedule.gap_manager->place_jobs(jobs);
+  schedule.placed_jobs = jobs;
+  EXPECT_FALSE(schedule.gap_manager->gaps.key_exists(2));
+
+  Job_List removed_jobs = schedule.unschedule_jobs({1});
+  ASSERT_EQ(removed_jobs.size(), 1);
+  EXPECT_FALSE(removed_jobs[0].starting_time.has_value());
+
+  EXPECT_EQ(schedule.placed_jobs.size(), 1);
+  EXPECT_EQ(schedule.gap_manager->gaps.size(), 2);
+  EXPECT_EQ(schedule.gap_manager->gaps[0], 6);
+  EXPECT_EQ(schedule.gap_manager->gaps[2], 4);
+  EXPECT_EQ(schedule.get_makespan(), 2);
+}
+
 TEST(Schedule_Tests, SplitAt) {
   uint m = 10;
   uint n = 9;
@@ -412,7 +823,7 @@ TEST(Schedule_Tests, BalancedListSchedule) {
   sigma2.gap_manager->available_machines_in_gap=1;
   sigma2.gap_manager->makespan=10;
 
-  sint h = 6;
+  Time_Difference h = 6;
 
   {
     Job_List jobs = {
@@ -463,7 +874,7 @@ TEST(Schedule_Tests, BalancedListSchedule2BalanceTime) {
   sigma2.gap_manager->available_machines_in_gap=1;
   sigma2.gap_manager->makespan=10;
 
-  sint h = 6;
+  Time_Difference h = 6;
 
   {
     Job_List jobs = {
@@ -509,7 +920,7 @@ TEST(Schedule_Tests, BalancedListScheduleZeroBalanceTime) {
   sigma2.gap_manager->available_machines_in_gap=2;
   sigma2.gap_manager->makespan=8;
 
-  sint h = 2;
+  Time_Difference h = 2;
 
   {
     Job_List jobs = {
@@ -657,6 +1068,244 @@ TEST(Schedule_Tests, RemoveJobsAbove) {
   EXPECT_EQ(schedule.placed_jobs[0].required_machines, 6);
 }
 
+TEST(Schedule_Tests, StackScheduleOnTop) {
+  uint m = 10;
+  uint n = 4;
+
+  Schedule lower(m,n);
+  Job J1 = Job(/*processing_time=*/2, /*required_machines=*/ 6);
+  Job J2 = Job(/*processing_time=*/3, /*required_machines=*/ 4);
+  lower.schedule_job(J1, 0);
+  lower.schedule_job(J2, 0);
+
+  Schedule upper(m,n);
+  Job J3 = Job(/*processing_time=*/1, /*required_machines=*/ 5);
+  Job J4 = Job(/*processing_time=*/4, /*required_machines=*/ 2);
+  upper.schedule_job(J3, 0);
+  upper.schedule_job(J4, 1);
+
+  lower.stack_schedule_on_top(upper);
+
+  EXPECT_EQ(lower.get_makespan(), 8);
+  EXPECT_EQ(upper.get_makespan(), 0);
+  EXPECT_EQ(upper.placed_jobs.size(), 0);
+  EXPECT_EQ(lower.placed_jobs.size(), 4);
+
+  // jobs of upper are not moved into the gap at time 2
+  EXPECT_EQ(lower.placed_jobs[2].starting_time.value(), 3);
+  EXPECT_EQ(lower.placed_jobs[2].required_machines, 5);
+  EXPECT_EQ(lower.placed_jobs[3].starting_time.value(), 4);
+  EXPECT_EQ(lower.placed_jobs[3].required_machines, 2);
+
+  EXPECT_EQ(lower.gap_manager->gaps[0], 0);
+  EXPECT_EQ(lower.gap_manager->gaps[2], 6);
+  EXPECT_EQ(lower.gap_manager->gaps[3], -1);
+  EXPECT_EQ(lower.gap_manager->gaps[4], 3);
+  EXPECT_EQ(lower.gap_manager->gaps[8], 2);
+
+  // list scheduling goes on at the last stacked job, the gap at time 2 is only free until time 3
+  uint time = lower.gap_manager->update_earliest_time_to_place(Job(2,6));
+  EXPECT_EQ(time, 4);
+}
+
+TEST(Schedule_Tests, RotatedScheduleView) {
+  uint m = 10;
+  uint n = 3;
+
+  Schedule schedule(m,n);
+  Job J1 = Job(/*processing_time=*/2, /*required_machines=*/ 6);
+  Job J2 = Job(/*processing_time=*/3, /*required_machines=*/ 4);
+  Job J3 = Job(/*processing_time=*/1, /*required_machines=*/ 5);
+  schedule.schedule_job(J1, 0);
+  schedule.schedule_job(J2, 0);
+  schedule.schedule_job(J3, 3);
+
+  Rotated_Schedule_View view = schedule.get_rotated_view();
+  EXPECT_EQ(view.get_makespan(), 4);
+  EXPECT_EQ(view.get_job(0).starting_time.value(), 2); // J1
+  EXPECT_EQ(view.get_job(1).starting_time.value(), 1); // J2
+  EXPECT_EQ(view.get_job(2).starting_time.value(), 0); // J3
+
+  vector<Gap> rotated_gaps = view.get_gaps();
+  ASSERT_EQ(rotated_gaps.size(), 4);
+  EXPECT_EQ(rotated_gaps[0].time, 0);
+  EXPECT_EQ(rotated_gaps[0].additional_machines, 5);
+  EXPECT_EQ(rotated_gaps[1].time, 1);
+  EXPECT_EQ(rotated_gaps[1].additional_machines, 1);
+  EXPECT_EQ(rotated_gaps[2].time, 2);
+  EXPECT_EQ(rotated_gaps[2].additional_machines, -6);
+  EXPECT_EQ(rotated_gaps[3].time, 4);
+  EXPECT_EQ(rotated_gaps[3].additional_machines, 10);
+
+  // the viewed schedule is unchanged
+  EXPECT_EQ(schedule.placed_jobs[0].starting_time.value(), 0);
+
+  Schedule rotated_schedule = view.materialize();
+  EXPECT_EQ(rotated_schedule.get_makespan(), 4);
+  EXPECT_EQ(rotated_schedule.placed_jobs[0].starting_time.value(), 0);
+  EXPECT_EQ(rotated_schedule.placed_jobs[0].required_machines, 5);
+  EXPECT_EQ(rotated_schedule.placed_jobs[2].starting_time.value(), 2);
+  EXPECT_EQ(rotated_schedule.placed_jobs[2].required_machines, 6);
+  EXPECT_EQ(rotated_schedule.gap_manager->gaps[0], 5);
+  EXPECT_EQ(rotated_schedule.gap_manager->gaps[2], -6);
+
+  // the materialized schedule can be changed
+  uint time = rotated_schedule.gap_manager->update_earliest_time_to_place(Job(1,6));
+  EXPECT_EQ(time, 1);
+}
+
+TEST(Tower_Schedule_Tests, SelectsBackendByJobsAndProjectedMakespan) {
+  Job_List jobs = {Job(10, 5), Job(10, 5)};
+  // area/m + p_max = 20
+  EXPECT_EQ(select_backend(jobs, 10, {/*flat_max_jobs=*/2, 20, Gap_Backend::map}), Gap_Backend::flat);
+  EXPECT_EQ(select_backend(jobs, 10, {/*flat_max_jobs=*/1, 20, Gap_Backend::map}), Gap_Backend::dense);
+  EXPECT_EQ(select_backend(jobs, 10, {/*flat_max_jobs=*/1, 19, Gap_Backend::map}), Gap_Backend::map);
+
+  Tower_Result result = schedule_with_selected_backend(10, jobs, {1, 20, Gap_Backend::tree});
+  EXPECT_EQ(result.backend, Gap_Backend::dense);
+  EXPECT_EQ(result.makespan, 10);
+}
+
+TEST(Tower_Schedule_Tests, CalibrationChecksThatTheBackendsAgree) {
+  // random instances like the benchmark ones, the calibration throws if a backend gives another schedule
+  // (with 10000 jobs the dense structure used to give another one, the makespan fits into 16-bit times)
+  Backend_Thresholds thresholds;
+  ASSERT_NO_THROW(thresholds = calibrate_backend_thresholds(/*m=*/30000, /*p_max=*/10, {100, 10000}));
+  EXPECT_TRUE(thresholds.tree_backend == Gap_Backend::tree || thresholds.tree_backend == Gap_Backend::map);
+}
+
+TEST(Tower_Schedule_Tests, RoundedScheduleKeepsOriginalProcessingTimes) {
+  Processing_Time_Rounding geometric = {Processing_Time_Rounding::geometric, /*epsilon=*/0.5, 0};
+  EXPECT_EQ(round_processing_time(1, geometric), 1);
+  // the values are ceil(1.5^k) = 1, 2, 3, 4, 6, 8, ...
+  EXPECT_EQ(round_processing_time(3, geometric), 3);
+  EXPECT_EQ(round_processing_time(5, geometric), 6);
+  EXPECT_EQ(round_processing_time(7, geometric), 8);
+  Processing_Time_Rounding grid = {Processing_Time_Rounding::grid, 0, /*grid_step=*/5};
+  EXPECT_EQ(round_processing_time(11, grid), 15);
+  EXPECT_EQ(round_processing_time(10, grid), 10);
+
+  uint m = 10;
+  Job_List jobs = {Job(9, 5), Job(10, 5), Job(3, 2), Job(4, 2), Job(5, 2), Job(1, 8)};
+  Tower_Schedule tower_schedule(m, jobs.size());
+  Rounding_Report report = tower_schedule.schedule_jobs_rounded(jobs, grid);
+
+  EXPECT_EQ(report.distinct_processing_times, 6);
+  EXPECT_EQ(report.distinct_rounded_processing_times, 3);
+  EXPECT_LE(report.makespan, report.rounded_makespan);
+  EXPECT_DOUBLE_EQ(report.lower_bound, 12.7);
+  EXPECT_DOUBLE_EQ(report.ratio, report.makespan / 12.7);
+
+  // every job is placed once with its own processing time
+  multiset<pair<Time, Machines>> expected, placed;
+  for(const Job& job : jobs)
+    expected.insert({job.processing_time, job.required_machines});
+  for(const Job& job : tower_schedule.sigma.placed_jobs)
+    placed.insert({job.processing_time, job.required_machines});
+  EXPECT_EQ(placed, expected);
+
+  // the gaps are the ones of the original jobs, so later changes keep the profile right
+  Gap_Manager original_gaps(m);
+  original_gaps.place_jobs(tower_schedule.sigma.placed_jobs);
+  EXPECT_EQ(tower_schedule.sigma.get_makespan(), report.makespan);
+  vector<Gap> gaps = tower_schedule.sigma.gap_manager->get_gaps(), expected_gaps = original_gaps.get_gaps();
+  ASSERT_EQ(gaps.size(), expected_gaps.size());
+  for(size_t i = 0; i < gaps.size(); i++) {
+    EXPECT_EQ(gaps[i].time, expected_gaps[i].time);
+    EXPECT_EQ(gaps[i].additional_machines, expected_gaps[i].additional_machines);
+  }
+  tower_schedule.cancel_job(0);
+  tower_schedule.add_jobs(Job_List{Job(2, 3), Job(1, 7)});
+  EXPECT_NO_THROW(assign_machines(tower_schedule.sigma.placed_jobs, m));
+}
+
+TEST(Tower_Schedule_Tests, RoundedRequiredMachinesStayInTheirClass) {
+  Machines m = 100;
+  Machine_Rounding grid = {Machine_Rounding::grid, 0, /*classes=*/10};
+  EXPECT_EQ(round_required_machines(1, m, grid), 1);
+  EXPECT_EQ(round_required_machines(20, m, grid), 20);
+  // the multiples of 10 are capped at the bounds m/4, m/3 and m/2
+  EXPECT_EQ(round_required_machines(21, m, grid), 25);
+  EXPECT_EQ(round_required_machines(31, m, grid), 33);
+  EXPECT_EQ(round_required_machines(45, m, grid), 50);
+  EXPECT_EQ(round_required_machines(51, m, grid), 60);
+  Machine_Rounding geometric = {Machine_Rounding::geometric, /*epsilon=*/0.5, 0};
+  EXPECT_EQ(round_required_machines(5, m, geometric), 6);
+
+  Job_List jobs = {Job(3, 21), Job(3, 22), Job(2, 31), Job(2, 32), Job(4, 51), Job(1, 38)};
+  Tower_Schedule tower_schedule(m, jobs.size());
+  Rounding_Report report = tower_schedule.schedule_jobs_rounded(jobs, {Processing_Time_Rounding::none, 0, 0}, grid);
+
+  EXPECT_EQ(report.distinct_required_machines, 6);
+  EXPECT_EQ(report.distinct_rounded_required_machines, 4);
+  EXPECT_GT(report.lost_utilization, 0);
+  EXPECT_LE(report.makespan, report.rounded_makespan);
+
+  multiset<pair<Time, Machines>> expected, placed;
+  for(const Job& job : jobs)
+    expected.insert({job.processing_time, job.required_machines});
+  for(const Job& job : tower_schedule.sigma.placed_jobs)
+    placed.insert({job.processing_time, job.required_machines});
+  EXPECT_EQ(placed, expected);
+}
+
+TEST(Tower_Schedule_Tests, AddJobsKeepsPlacedJobsUnlessTheRatioBreaks) {
+  Machines m = 100;
+  Tower_Schedule tower_schedule(m, 1);
+  tower_schedule.schedule_jobs(Job_List{Job(10, m)});
+  EXPECT_DOUBLE_EQ(tower_schedule.full_schedule_ratio, 1.0);
+
+  // 11 / max(10.01, 10) is within the slack, the big job stays where it is
+  Tower_Schedule incremental = tower_schedule.get_copy();
+  EXPECT_FALSE(incremental.add_jobs(Job_List{Job(1, 1)}, /*slack=*/0.2));
+  ASSERT_EQ(incremental.sigma.placed_jobs.size(), 2);
+  EXPECT_EQ(incremental.sigma.placed_jobs[0].starting_time, 0);
+  EXPECT_EQ(incremental.sigma.placed_jobs[1].starting_time, 10);
+  EXPECT_EQ(incremental.n, 2);
+
+  // the copy has its own gaps
+  EXPECT_EQ(incremental.sigma.get_makespan(), 11);
+  EXPECT_EQ(tower_schedule.sigma.get_makespan(), 10);
+  EXPECT_EQ(tower_schedule.sigma.gap_manager->get_number_of_gaps(), 2);
+
+  // without slack everything is scheduled again
+  EXPECT_TRUE(tower_schedule.add_jobs(Job_List{Job(1, 1)}, /*slack=*/0));
+  EXPECT_EQ(tower_schedule.sigma.placed_jobs.size(), 2);
+  EXPECT_EQ(tower_schedule.sigma.get_makespan(), 11);
+  EXPECT_EQ(tower_schedule.total_area, 10*m + 1);
+}
+
+TEST(Tower_Schedule_Tests, BalancedListScheduleTerminatesWhenOnlyNarrowJobsFit) {
+  // the widest fitting tiny job did not fit below the balance time, but the narrowest did,
+  // so the balance time was never lowered
+  Machines m = 100;
+  Job_List jobs = {Job(3, 25), Job(3, 25), Job(2, 33), Job(2, 33), Job(4, 60), Job(1, 10)};
+  Tower_Schedule tower_schedule(m, jobs.size());
+  tower_schedule.schedule_jobs(jobs);
+  EXPECT_EQ(tower_schedule.sigma.placed_jobs.size(), jobs.size());
+  EXPECT_EQ(tower_schedule.sigma.get_makespan(), 7);
+}
+
+TEST(Tower_Schedule_Tests, AllBackendsGiveTheSameSchedule) {
+  // the second instance is like the benchmark ones (many wide jobs), where sigma1 used to be overfilled with tiny jobs
+  // and the tree differed from the dense structure (m fits into 16-bit machines)
+  for(auto [m, n] : {pair<uint, uint>{100, 60}, pair<uint, uint>{30000, 100}}) {
+    Job_List jobs;
+    for(uint i = 0; i < n; i++)
+      jobs.push_back(m == 100 ? Job(1 + (i*7) % 13, 1 + (i*37) % m) : Job(1 + (i*37) % 100, 1 + (i*7919) % m));
+
+    Tower_Result tree_result = schedule_with_backend(Gap_Backend::tree, m, jobs);
+    EXPECT_NO_THROW(assign_machines(tree_result.placed_jobs, m));
+    for(Gap_Backend backend : {Gap_Backend::map, Gap_Backend::flat, Gap_Backend::dense}) {
+      Tower_Result result = schedule_with_backend(backend, m, jobs);
+      EXPECT_EQ(result.makespan, tree_result.makespan) << get_backend_name(backend) << " m=" << m;
+      ASSERT_EQ(result.placed_jobs.size(), tree_result.placed_jobs.size());
+      for(size_t i = 0; i < result.placed_jobs.size(); i++)
+        EXPECT_EQ(result.placed_jobs[i].starting_time, tree_result.placed_jobs[i].starting_time);
+    }
+  }
+}
+
 TEST(Tower_Schedule_Tests, Sigma1Example) {
   uint m = 100;
   uint n = 20;
@@ -1292,3 +1941,474 @@ TEST(Tower_Schedule_Tests, ManyTinyBalanceNegative) {
   EXPECT_EQ(tower_schedule.sigma.placed_jobs[44+5].starting_time.value(),210+10);
   EXPECT_EQ(tower_schedule.sigma.placed_jobs[45+5].starting_time.value(),230+10);
 }
+
+TEST(Tower_Schedule_Tests, SpeculativeScheduleKeepsTheShorterFinishing) {
+  uint m = 16;
+  Job_List jobs = {Job(3,5), Job(8,5), Job(9,8), Job(7,5), Job(1,1)};
+
+  Tower_Schedule tower_schedule(m, jobs.size());
+  tower_schedule.schedule_jobs(jobs);
+  EXPECT_EQ(tower_schedule.sigma.get_makespan(), 17);
+
+  Tower_Schedule speculative_schedule(m, jobs.size());
+  speculative_schedule.schedule_jobs_speculatively(jobs);
+  EXPECT_EQ(speculative_schedule.sigma.get_makespan(), 15);
+  ASSERT_EQ(speculative_schedule.sigma.placed_jobs.size(), jobs.size());
+  EXPECT_NO_THROW(assign_machines(speculative_schedule.sigma.placed_jobs, m));
+}
+
+TEST(Schedule_Tests, CopyDoesNotShareTheGaps) {
+  Schedule schedule(10, 2);
+  Job J1 = Job(/*processing_time=*/2, /*required_machines=*/ 6);
+  schedule.schedule_job(J1, 0);
+
+  Schedule copy = schedule.get_copy();
+  Job J2 = Job(/*processing_time=*/3, /*required_machines=*/ 4);
+  copy.schedule_job(J2, 2);
+
+  EXPECT_EQ(schedule.get_makespan(), 2);
+  EXPECT_EQ(schedule.placed_jobs.size(), 1);
+  EXPECT_EQ(copy.get_makespan(), 5);
+  EXPECT_EQ(copy.placed_jobs.size(), 2);
+}
+
+TEST(Schedule_Tests, CompactMovesJobsIntoEarlierHoles) {
+  Schedule schedule(10, 4);
+  Job J1 = Job(/*processing_time=*/2, /*required_machines=*/ 6);
+  Job J2 = Job(/*processing_time=*/3, /*required_machines=*/ 8);
+  Job J3 = Job(/*processing_time=*/2, /*required_machines=*/ 4);
+  Job J4 = Job(/*processing_time=*/1, /*required_machines=*/ 5);
+  schedule.schedule_job(J1, 0);
+  schedule.schedule_job(J2, 2);
+  schedule.schedule_job(J3, 5);
+  schedule.schedule_job(J4, 7);
+
+  // J3 fits next to J1, J4 can not be placed next to J2
+  EXPECT_EQ(schedule.compact(), 6);
+  vector<pair<Time, Machines>> starting_times;
+  for(const Job& job : schedule.placed_jobs)
+    starting_times.push_back({job.starting_time.value(), job.required_machines});
+  sort(starting_times.begin(), starting_times.end());
+  vector<pair<Time, Machines>> expected_starting_times = {{0, 4}, {0, 6}, {2, 8}, {5, 5}};
+  EXPECT_EQ(starting_times, expected_starting_times);
+  EXPECT_NO_THROW(assign_machines(schedule.placed_jobs, 10));
+}
+
+TEST(Tower_Schedule_Tests, CompactionNeverDelaysAJob) {
+  Machines m = 30;
+  Job_List jobs;
+  for(uint i = 0; i < 200; i++)
+    jobs.push_back(Job(1 + (i*7) % 13, 1 + (i*11) % m));
+  Tower_Schedule tower_schedule(m, jobs.size());
+  tower_schedule.schedule_jobs(jobs);
+  Time makespan = tower_schedule.sigma.get_makespan();
+
+  // the starting times of the jobs of one size, sorted
+  auto get_starting_times = [](const Job_List& placed_jobs) {
+    map<pair<Time, Machines>, vector<Time>> starting_times;
+    for(const Job& job : placed_jobs)
+      starting_times[{job.processing_time, job.required_machines}].push_back(job.starting_time.value());
+    for(auto& [size, times] : starting_times)
+      sort(times.begin(), times.end());
+    return starting_times;
+  };
+  auto old_starting_times = get_starting_times(tower_schedule.sigma.placed_jobs);
+
+  EXPECT_LE(tower_schedule.compact(), makespan);
+  EXPECT_NO_THROW(assign_machines(tower_schedule.sigma.placed_jobs, m));
+  auto new_starting_times = get_starting_times(tower_schedule.sigma.placed_jobs);
+  ASSERT_EQ(new_starting_times.size(), old_starting_times.size());
+  for(auto& [size, times] : new_starting_times)
+    for(size_t i = 0; i < times.size(); i++)
+      EXPECT_LE(times[i], old_starting_times[size][i]);
+}
+
+TEST(Machine_Assignment_Tests, AssignsDisjointMachinesToOverlappingJobs) {
+  Machines m = 20;
+  Job_List jobs;
+  for(uint i = 0; i < 80; i++)
+    jobs.push_back(Job(1 + (i*7) % 11, 1 + (i*13) % m));
+  Tower_Schedule tower_schedule(m, jobs.size());
+  tower_schedule.schedule_jobs(jobs);
+  const Job_List& placed_jobs = tower_schedule.sigma.placed_jobs;
+
+  for(Machine_Assignment_Mode mode : {Machine_Assignment_Mode::first_fit, Machine_Assignment_Mode::contiguous}) {
+    Machine_Assignment assignment = assign_machines(placed_jobs, m, mode);
+    ASSERT_EQ(assignment.get_number_of_jobs(), placed_jobs.size());
+
+    // job running on every machine at every time
+    vector<vector<int>> running_job(tower_schedule.sigma.get_makespan(), vector<int>(m, -1));
+    for(uint job = 0; job < placed_jobs.size(); job++) {
+      Machines machines = 0;
+      const Machine_Range* ranges = assignment.get_ranges(job);
+      for(size_t i = 0; i < assignment.get_number_of_ranges(job); i++) {
+        machines += ranges[i].count;
+        ASSERT_LE(ranges[i].first_machine + ranges[i].count, m);
+        for(Time t = *placed_jobs[job].starting_time; t < *placed_jobs[job].starting_time + placed_jobs[job].processing_time; t++)
+          for(Machines machine = ranges[i].first_machine; machine < ranges[i].first_machine + ranges[i].count; machine++) {
+            EXPECT_EQ(running_job[t][machine], -1);
+            running_job[t][machine] = job;
+          }
+      }
+      EXPECT_EQ(machines, placed_jobs[job].required_machines);
+    }
+  }
+}
+
+TEST(Machine_Assignment_Tests, ContiguousModePrefersOneRange) {
+  Machines m = 10;
+  // after the first jobs end the free machines are [0,3), [5,6) and [6,10) merged to [5,10)
+  Job_List placed_jobs = {Job(1, 3), Job(2, 2), Job(1, 5), Job(1, 4)};
+  placed_jobs[0].starting_time = 0;
+  placed_jobs[1].starting_time = 0;
+  placed_jobs[2].starting_time = 0;
+  placed_jobs[3].starting_time = 1;
+
+  Machine_Assignment first_fit = assign_machines(placed_jobs, m);
+  ASSERT_EQ(first_fit.get_number_of_ranges(3), 2);
+  EXPECT_EQ(first_fit.get_ranges(3)[0].first_machine, 0);
+  EXPECT_EQ(first_fit.get_ranges(3)[1].first_machine, 5);
+  EXPECT_EQ(first_fit.get_number_of_fragmented_jobs(), 1);
+
+  Machine_Assignment contiguous = assign_machines(placed_jobs, m, Machine_Assignment_Mode::contiguous);
+  ASSERT_EQ(contiguous.get_number_of_ranges(3), 1);
+  EXPECT_EQ(contiguous.get_ranges(3)[0].first_machine, 5);
+  EXPECT_EQ(contiguous.get_number_of_fragmented_jobs(), 0);
+
+  ostringstream out;
+  write_machine_assignment(out, contiguous);
+  EXPECT_EQ(out.str(), "0 0 3\n1 3 2\n2 5 5\n3 5 4\n");
+
+  placed_jobs.push_back(Job(1, 5));
+  placed_jobs.back().starting_time = 1;
+  EXPECT_THROW(assign_machines(placed_jobs, m), runtime_error);
+}
+
+TEST(Service_Tests, AnswersRequestsOfAStream) {
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  thread service([&]() { serve_stream(fds[1], fds[1], DEFAULT_BACKEND_THRESHOLDS); close(fds[1]); });
+
+  // m, n, then the jobs
+  vector<unsigned long long> request = {10, 4, 3, 6, 3, 6, 2, 4, 1, 10};
+  vector<unsigned long long> bad_request = {10, 1, 3, 11};
+  ASSERT_EQ(write(fds[0], request.data(), request.size()*8), request.size()*8);
+  ASSERT_EQ(write(fds[0], bad_request.data(), bad_request.size()*8), bad_request.size()*8);
+  shutdown(fds[0], SHUT_WR);
+
+  // the reply is written in two parts, MSG_WAITALL waits for both
+  vector<unsigned long long> reply(3+4);
+  ASSERT_EQ(recv(fds[0], reply.data(), reply.size()*8, MSG_WAITALL), reply.size()*8);
+  EXPECT_EQ(reply[0], SERVICE_OK);
+  EXPECT_EQ(reply[2], 4);
+
+  // the starting times belong to the jobs of the request
+  map<unsigned long long, long long> changes;
+  unsigned long long makespan = 0;
+  for(size_t i = 0; i < 4; i++) {
+    unsigned long long starting_time = reply[3+i], processing_time = request[2+2*i], required_machines = request[3+2*i];
+    changes[starting_time] += required_machines;
+    changes[starting_time + processing_time] -= required_machines;
+    makespan = max(makespan, starting_time + processing_time);
+  }
+  EXPECT_EQ(reply[1], makespan);
+  long long used_machines = 0;
+  for(auto [time, change] : changes)
+    EXPECT_LE(used_machines += change, 10);
+
+  unsigned long long error_header[3];
+  ASSERT_EQ(recv(fds[0], error_header, sizeof(error_header), MSG_WAITALL), sizeof(error_header));
+  EXPECT_EQ(error_header[0], SERVICE_ERROR);
+  string error(error_header[2], ' ');
+  ASSERT_EQ(recv(fds[0], error.data(), error.size(), MSG_WAITALL), error.size());
+  EXPECT_EQ(error, "job requires more than m machines");
+
+  service.join();
+  close(fds[0]);
+}
+
+TEST(Service_Tests, IdleConnectionsDoNotKeepTheWorkers) {
+  string path = (filesystem::temp_directory_path() / ("pts_service_test_" + to_string(getpid()))).string();
+  // the service does not return, it ends with the test program
+  thread([path]() { serve_unix_socket(path, /*workers=*/1, DEFAULT_BACKEND_THRESHOLDS); }).detach();
+
+  auto connect_to_service = [&]() {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path.c_str());
+    for(int attempt = 0; attempt < 1000; attempt++) {
+      int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+      if(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0)
+        return fd;
+      close(fd);
+      this_thread::sleep_for(chrono::milliseconds(5));
+    }
+    return -1;
+  };
+  // the reply has to arrive within 10 seconds
+  auto ask = [](int fd, const vector<unsigned long long>& request) {
+    vector<unsigned long long> reply(3 + request[1]);
+    if(write(fd, request.data(), request.size()*8) != static_cast<ssize_t>(request.size()*8))
+      return vector<unsigned long long>{};
+    pollfd reply_fd = {fd, POLLIN, 0};
+    if(poll(&reply_fd, 1, 10000) != 1 || recv(fd, reply.data(), reply.size()*8, MSG_WAITALL) != static_cast<ssize_t>(reply.size()*8))
+      return vector<unsigned long long>{};
+    return reply;
+  };
+
+  // one worker and two clients which stay connected, the second one is answered while the first one is idle
+  int idle_fd = connect_to_service(), fd = connect_to_service();
+  ASSERT_GE(idle_fd, 0);
+  ASSERT_GE(fd, 0);
+  vector<unsigned long long> reply = ask(fd, {10, 2, 3, 6, 2, 4});
+  ASSERT_EQ(reply.size(), 5);
+  EXPECT_EQ(reply[0], SERVICE_OK);
+  EXPECT_EQ(reply[1], 3);
+
+  // both connections can send further requests
+  reply = ask(idle_fd, {10, 1, 4, 2});
+  ASSERT_EQ(reply.size(), 4);
+  EXPECT_EQ(reply[1], 4);
+  reply = ask(fd, {10, 1, 5, 2});
+  ASSERT_EQ(reply.size(), 4);
+  EXPECT_EQ(reply[1], 5);
+
+  close(idle_fd);
+  close(fd);
+  filesystem::remove(path);
+}
+
+TEST(Service_Tests, OnlyReplacesASocketFile) {
+  filesystem::path path = filesystem::temp_directory_path() / ("pts_not_a_socket_" + to_string(getpid()));
+  ofstream(path) << "data";
+  EXPECT_THROW(serve_unix_socket(path.string(), 1, DEFAULT_BACKEND_THRESHOLDS), runtime_error);
+  EXPECT_TRUE(filesystem::exists(path));
+  filesystem::remove(path);
+}
+
+TEST(Job_Queue_Tests, BoundedQueueIsFirstInFirstOut) {
+  Job_Queue queue(3);
+  EXPECT_EQ(queue.get_capacity(), 4);
+
+  Submission_Time now = chrono::steady_clock::now();
+  for(Time p = 1; p <= 4; p++)
+    EXPECT_TRUE(queue.try_push(Job(p, 1), now));
+  EXPECT_FALSE(queue.try_push(Job(5, 1), now));
+  EXPECT_EQ(queue.get_depth(), 4);
+
+  Job job(0, 0);
+  Submission_Time submission_time;
+  for(Time p = 1; p <= 4; p++) {
+    ASSERT_TRUE(queue.try_pop(job, submission_time));
+    EXPECT_EQ(job.processing_time, p);
+  }
+  EXPECT_FALSE(queue.try_pop(job, submission_time));
+  EXPECT_TRUE(queue.try_push(Job(5, 1), now));
+}
+
+TEST(Job_Queue_Tests, BatcherSchedulesAllSubmittedJobs) {
+  Machines m = 100;
+  Tower_Schedule tower_schedule(m, 0);
+  Batching_Policy policy = {/*max_batch_size=*/64, /*max_delay=*/chrono::microseconds(200), /*idle_sleep=*/chrono::microseconds(10)};
+
+  unsigned long long rejected = 0;
+  {
+    Job_Batcher batcher(/*capacity=*/256, policy, [&](const Job_List& batch) { tower_schedule.add_jobs(batch); });
+    vector<thread> submitters;
+    atomic<unsigned long long> rejected_submissions = 0;
+    for(uint t = 0; t < 4; t++)
+      submitters.emplace_back([&, t]() {
+        for(uint i = 0; i < 500; i++)
+          if(!batcher.submit(Job(1 + (i*7 + t) % 13, 1 + (i*37 + t) % m)))
+            rejected_submissions++;
+      });
+    for(thread& submitter : submitters)
+      submitter.join();
+    batcher.stop();
+    rejected = rejected_submissions;
+
+    Batcher_Metrics metrics = batcher.get_metrics();
+    EXPECT_EQ(metrics.submitted_jobs + metrics.rejected_jobs, 2000);
+    EXPECT_EQ(metrics.rejected_jobs, rejected);
+    EXPECT_EQ(metrics.scheduled_jobs, metrics.submitted_jobs);
+    EXPECT_GE(metrics.batches, metrics.scheduled_jobs / 64);
+    EXPECT_EQ(metrics.queue_depth, 0);
+    EXPECT_LE(metrics.max_queue_depth, 256);
+    EXPECT_FALSE(batcher.submit(Job(1, 1)));
+  }
+  EXPECT_EQ(tower_schedule.sigma.placed_jobs.size(), 2000 - rejected);
+}
+
+TEST(Anytime_Tests, ZeroBudgetReturnsTheGreedySchedule) {
+  Machines m = 10;
+  Job_List jobs = {Job(3, 6), Job(2, 5), Job(4, 5), Job(1, 4), Job(5, 2), Job(2, 10)};
+
+  Anytime_Result result = schedule_jobs_within(m, jobs, chrono::microseconds(0));
+  EXPECT_EQ(result.stage, Anytime_Stage::greedy);
+  ASSERT_EQ(result.placed_jobs.size(), jobs.size());
+  EXPECT_NO_THROW(assign_machines(result.placed_jobs, m));
+
+  Job_List sorted_jobs = jobs;
+  sort_jobs_decreasingly_by_required_machines(sorted_jobs);
+  Schedule greedy(m, jobs.size());
+  greedy.list_schedule(sorted_jobs);
+  EXPECT_EQ(result.makespan, greedy.get_makespan());
+  EXPECT_DOUBLE_EQ(result.ratio, result.makespan / get_makespan_lower_bound(jobs, m));
+}
+
+TEST(Anytime_Tests, LargeBudgetIsAtLeastAsGoodAsGreedyAndTower) {
+  Machines m = 100;
+  Job_List jobs;
+  for(uint i = 0; i < 500; i++)
+    jobs.emplace_back(1 + (i*7) % 23, 1 + (i*37) % m);
+
+  Anytime_Result result = schedule_jobs_within(m, jobs, chrono::seconds(10));
+  ASSERT_EQ(result.placed_jobs.size(), jobs.size());
+  EXPECT_NO_THROW(assign_machines(result.placed_jobs, m));
+  for(const Job& job : result.placed_jobs)
+    EXPECT_LE(job.starting_time.value() + job.processing_time, result.makespan);
+
+  Tower_Schedule tower_schedule(m, jobs.size());
+  tower_schedule.schedule_jobs(jobs);
+  EXPECT_LE(result.makespan, tower_schedule.sigma.get_makespan());
+  EXPECT_LE(result.makespan, schedule_jobs_within(m, jobs, chrono::microseconds(0)).makespan);
+  EXPECT_GE(result.ratio, 1.0);
+  EXPECT_LT(result.elapsed_ms, 10000);
+}
+
+TEST(Portfolio_Tests, ReturnsTheShortestScheduleOfAllStrategies) {
+  Machines m = 100;
+  Job_List jobs;
+  for(uint i = 0; i < 500; i++)
+    jobs.emplace_back(1 + (i*7) % 23, 1 + (i*37) % m);
+
+  Portfolio_Result result = schedule_portfolio(m, jobs);
+  ASSERT_EQ(result.reports.size(), DEFAULT_PORTFOLIO.size());
+  ASSERT_EQ(result.placed_jobs.size(), jobs.size());
+  EXPECT_NO_THROW(assign_machines(result.placed_jobs, m));
+
+  for(size_t i = 0; i < result.reports.size(); i++) {
+    EXPECT_EQ(result.reports[i].strategy, DEFAULT_PORTFOLIO[i]);
+    EXPECT_LE(result.makespan, result.reports[i].makespan);
+    EXPECT_GE(result.reports[i].elapsed_ms, 0.0);
+  }
+  auto best = find_if(result.reports.begin(), result.reports.end(), [&](const Strategy_Report& report) {
+    return report.makespan == result.makespan;
+  });
+  ASSERT_NE(best, result.reports.end());
+  EXPECT_EQ(best->strategy, result.strategy);
+
+  Tower_Schedule tower_schedule(m, jobs.size());
+  tower_schedule.schedule_jobs(jobs);
+  EXPECT_EQ(result.reports[0].makespan, tower_schedule.sigma.get_makespan());
+
+  Job_List list_jobs = jobs;
+  Schedule sigma(m, jobs.size());
+  sigma.list_schedule(list_jobs);
+  EXPECT_EQ(result.reports[1].makespan, sigma.get_makespan());
+}
+
+TEST(Portfolio_Tests, RunsASingleStrategyAndRejectsAnEmptyPortfolio) {
+  Machines m = 10;
+  Job_List jobs = {Job(3, 6), Job(2, 5), Job(4, 5), Job(1, 4), Job(5, 2), Job(2, 10)};
+
+  Portfolio_Result result = schedule_portfolio(m, jobs, {Portfolio_Strategy::decreasing_processing_time});
+  ASSERT_EQ(result.reports.size(), 1);
+  EXPECT_EQ(result.strategy, Portfolio_Strategy::decreasing_processing_time);
+  EXPECT_EQ(result.makespan, result.reports[0].makespan);
+  EXPECT_NO_THROW(assign_machines(result.placed_jobs, m));
+
+  EXPECT_THROW(schedule_portfolio(m, jobs, {}), invalid_argument);
+}
+
+TEST(Multi_Start_Tests, ResultDependsOnlyOnTheSeed) {
+  Machines m = 100;
+  Job_List jobs;
+  for(uint i = 0; i < 300; i++)
+    jobs.emplace_back(1 + (i*7) % 23, 1 + (i*37) % m);
+
+  Multi_Start_Result sequential = schedule_with_restarts(m, jobs, /*restarts=*/8, /*threads=*/1, /*seed=*/42);
+  Multi_Start_Result parallel = schedule_with_restarts(m, jobs, /*restarts=*/8, /*threads=*/3, /*seed=*/42);
+  EXPECT_EQ(sequential.makespans, parallel.makespans);
+  EXPECT_EQ(sequential.best_restart, parallel.best_restart);
+  EXPECT_EQ(sequential.makespan, parallel.makespan);
+  ASSERT_EQ(parallel.placed_jobs.size(), jobs.size());
+  EXPECT_NO_THROW(assign_machines(parallel.placed_jobs, m));
+
+  EXPECT_EQ(parallel.makespan, *min_element(parallel.makespans.begin(), parallel.makespans.end()));
+  EXPECT_EQ(parallel.makespans[parallel.best_restart], parallel.makespan);
+}
+
+TEST(Multi_Start_Tests, FirstRestartKeepsTheOrderOfTheJobs) {
+  Machines m = 16;
+  Job_List jobs = {Job(3,5), Job(8,5), Job(9,8), Job(7,5), Job(1,1)};
+
+  Multi_Start_Result result = schedule_with_restarts(m, jobs, /*restarts=*/1, /*threads=*/4, /*seed=*/7);
+  Tower_Schedule tower_schedule(m, jobs.size());
+  tower_schedule.schedule_jobs(jobs);
+  EXPECT_EQ(result.makespan, tower_schedule.sigma.get_makespan());
+  EXPECT_EQ(result.best_restart, 0);
+  EXPECT_EQ(result.makespans.size(), 1);
+
+  EXPECT_THROW(schedule_with_restarts(m, jobs, /*restarts=*/0, /*threads=*/1, /*seed=*/7), invalid_argument);
+}
+
+TEST(Streaming_Tests, SlicesAreScheduledOnTopOfEachOther) {
+  Machines m = 40;
+  Job_List jobs;
+  for(uint i = 0; i < 500; i++)
+    jobs.emplace_back(1 + (i*7) % 19, 1 + (i*13) % m);
+
+  filesystem::path directory = filesystem::temp_directory_path();
+  string instance_path = (directory / "pts_streaming_test_instance.txt").string();
+  string output_path = (directory / "pts_streaming_test_output.bin").string();
+  {
+    ofstream instance(instance_path);
+    for(const Job& job : jobs)
+      instance << job.processing_time << " " << job.required_machines << "\n";
+  }
+
+  Streaming_Report report = schedule_stream(instance_path, output_path, m, {/*max_jobs_in_memory=*/64, directory.string()});
+  EXPECT_EQ(report.n, jobs.size());
+  EXPECT_EQ(report.slices, 8);
+  unsigned long long counted_jobs = 0;
+  for(unsigned long long count : report.class_counts)
+    counted_jobs += count;
+  EXPECT_EQ(counted_jobs, jobs.size());
+
+  // the starting times are in the order of the instance
+  EXPECT_EQ(filesystem::file_size(output_path), jobs.size() * sizeof(unsigned long long));
+  ifstream output(output_path, ios::binary);
+  Time makespan = 0;
+  for(Job& job : jobs) {
+    unsigned long long starting_time;
+    ASSERT_TRUE(output.read(reinterpret_cast<char*>(&starting_time), sizeof(starting_time)));
+    job.starting_time = starting_time;
+    makespan = max<Time>(makespan, starting_time + job.processing_time);
+  }
+  EXPECT_EQ(makespan, report.makespan);
+  EXPECT_NO_THROW(assign_machines(jobs, m));
+
+  // every slice leaves some idle machines at its top (less, the larger the slices are)
+  Tower_Schedule tower_schedule(m, jobs.size());
+  tower_schedule.schedule_jobs(jobs);
+  EXPECT_LE(report.makespan, 1.2 * tower_schedule.sigma.get_makespan());
+
+  filesystem::remove(instance_path);
+  filesystem::remove(output_path);
+}
+
+TEST(Streaming_Tests, JobWithTooManyMachinesIsRejected) {
+  filesystem::path directory = filesystem::temp_directory_path();
+  string instance_path = (directory / "pts_streaming_test_invalid.txt").string();
+  string output_path = (directory / "pts_streaming_test_invalid.bin").string();
+  {
+    ofstream instance(instance_path);
+    instance << "3 4\n2 11\n";
+  }
+  EXPECT_THROW(schedule_stream(instance_path, output_path, 10), out_of_range);
+  EXPECT_THROW(schedule_stream(instance_path, output_path, 10, {/*max_jobs_in_memory=*/0, ""}), invalid_argument);
+
+  filesystem::remove(instance_path);
+  filesystem::remove(output_path);
+}